@@ -37,7 +37,8 @@ enum class AllocType
     Empty,                                                                      // - пустой указатель;
     Static,                                                                     // - память выделена статически (данные на стеке или в глобальной области);
     DynamicSingle,                                                              // - память выделена в куче с помощью оператора new;
-    DynamicMultiple                                                             // - память выделена в куче с помощью оператора new[].
+    DynamicMultiple,                                                            // - память выделена в куче с помощью оператора new[];
+    Shared                                                                      // - указатель ссылается на разделяемый объект, которым владеет другой указатель.
 };
 
 template <typename T>                                                           // Структура-обертка над указателем для сериализации
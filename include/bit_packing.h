@@ -0,0 +1,116 @@
+/*  Функции для упаковки целых чисел в минимальное количество бит.
+    Используются для сжатия ключей упорядоченных ассоциативных
+    контейнеров (std::set, std::multiset, std::map, std::multimap)
+    с целочисленными ключами: первый ключ записывается целиком,
+    остальные – разностями с предыдущим ключом (ключи упорядочены
+    по возрастанию, поэтому разности неотрицательны и для плотных
+    наборов занимают несколько бит). Разности упаковываются блоками
+    по packed_block_size значений: [ширина в битах][упакованные биты].
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <set>
+#include <utility>
+
+template <typename T>                                                           // Проверка на целочисленный ключ, который можно упаковать.
+struct is_packable_key
+    : std::integral_constant<bool, std::is_integral<T>::value &&
+                                   !std::is_same<T, bool>::value> {};
+
+template <typename T>                                                           // Проверка на упорядоченный по возрастанию ассоциативный
+struct has_packable_keys : std::false_type {};                                  // контейнер с целочисленными ключами (только со стандартными
+                                                                                // компаратором и аллокатором).
+template <typename Key>
+struct has_packable_keys<std::set<Key>> : is_packable_key<Key> {};
+
+template <typename Key>
+struct has_packable_keys<std::multiset<Key>> : is_packable_key<Key> {};
+
+template <typename Key, typename Value>
+struct has_packable_keys<std::map<Key, Value>> : is_packable_key<Key> {};
+
+template <typename Key, typename Value>
+struct has_packable_keys<std::multimap<Key, Value>> : is_packable_key<Key> {};
+
+static const size_t packed_block_size = 128;                                    // Количество значений в блоке упаковки.
+static const unsigned max_packed_width = 64;                                    // Максимальная ширина значения в битах.
+
+template <typename Key>                                                         // Функция для получения ключа из элемента множества
+const Key& packed_key(const Key& key)                                           // или отображения.
+{
+    return key;
+}
+
+template <typename Key, typename Value>
+const Key& packed_key(const std::pair<const Key, Value>& item)
+{
+    return item.first;
+}
+
+template <typename Key, typename Value>                                         // Элемент FlatMap (см. flat_containers.h).
+const Key& packed_key(const std::pair<Key, Value>& item)
+{
+    return item.first;
+}
+
+inline unsigned bit_width(uint64_t value)                                       // Функция для вычисления количества значащих бит числа.
+{
+    unsigned width = 0;
+    while (width < max_packed_width && (value >> width))
+    {
+        width++;
+    }
+    return width;
+}
+
+inline size_t packed_bytes(size_t count, unsigned width)                        // Функция для вычисления размера блока из count значений
+{                                                                               // шириной width бит (в байтах).
+    return (count * width + 7) / 8;
+}
+
+inline void pack_bits(const uint64_t* values, size_t count,                     // Функция для упаковки count значений шириной width бит
+                      unsigned width, char* out)                                // в массив out (младшие биты – первыми).
+{
+    std::memset(out, 0, packed_bytes(count, width));
+    size_t bit = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        for (unsigned done = 0; done < width; )                                 // Записываем значение частями, не пересекающими
+        {                                                                       // границы байт.
+            unsigned offset = bit & 7;
+            unsigned take = std::min(width - done, 8 - offset);
+            auto part = (values[i] >> done) & ((1u << take) - 1);
+            out[bit >> 3] |= static_cast<char>(part << offset);
+            done += take;
+            bit += take;
+        }
+    }
+}
+
+inline void unpack_bits(const char* in, size_t count,                           // Функция для распаковки count значений шириной width бит
+                        unsigned width, uint64_t* values)                       // из массива in.
+{
+    size_t bit = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t value = 0;
+        for (unsigned done = 0; done < width; )
+        {
+            unsigned offset = bit & 7;
+            unsigned take = std::min(width - done, 8 - offset);
+            uint64_t part = (static_cast<uint8_t>(in[bit >> 3]) >> offset) &
+                            ((1u << take) - 1);
+            value |= part << done;
+            done += take;
+            bit += take;
+        }
+        values[i] = value;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,193 @@
+/*  Раскладка «смещения и блок данных» для вложенных непрерывных
+    контейнеров: векторов строк и векторов векторов арифметических
+    типов (например, токенизированного текста). Обычно такой вектор
+    записывается как N отдельных элементов с префиксами длины, и при
+    чтении каждый элемент читается отдельно. Если архиву включена
+    раскладка (Archive::set_blob_layout), после количества элементов
+    записываются массив концов элементов (uint32_t, в элементах
+    внутренних контейнеров) и одним блоком – данные всех элементов:
+
+        [N][end_0 ... end_N-1][data_0 data_1 ... data_N-1]
+
+    При чтении концы и данные читаются двумя операциями, а элементы
+    заполняются копированием из блока.
+    Шаблон класса BlobSequence<Item> хранит последовательность в этом же
+    виде (массив концов и один блок данных) и дает доступ к элементам
+    как к представлениям BlobView<Item> без выделения памяти под каждый
+    элемент. BlobSequence всегда записывается в этой раскладке: архив,
+    записанный из std::vector<std::string> с включенной раскладкой,
+    читается в BlobSequence<char> и наоборот.
+    К векторам строк раскладка не применяется при включенном словаре
+    строк (строки записываются ссылками на словарь).
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "traits.h"
+#include "decoding_limits.h"
+
+template <typename T>                                                           // Проверка на вектор непрерывных контейнеров
+struct is_nested_contiguous : std::false_type {};                               // фундаментальных значений (векторов или строк).
+
+template <typename Inner, typename Allocator>
+struct is_nested_contiguous<std::vector<Inner, Allocator>>
+    : std::conditional<is_std_vector<Inner>::value ||
+                       is_std_string<Inner>::value,
+                       is_contiguous_arithmetic<Inner>,
+                       std::false_type>::type {};
+
+inline bool valid_blob_ends(const std::vector<uint32_t>& ends)                  // Функция для проверки массива концов элементов (концы
+{                                                                               // не убывают).
+    return std::is_sorted(ends.begin(), ends.end());
+}
+
+template <typename Item>
+class BlobView                                                                  // Представление элемента BlobSequence (указатель на данные
+{                                                                               // и их размер).
+public:
+    using value_type = Item;
+
+    BlobView(const Item* first, size_t count) : first(first), count(count) {}
+
+    const Item* begin() const
+    {
+        return first;
+    }
+
+    const Item* end() const
+    {
+        return first + count;
+    }
+
+    const Item* data() const
+    {
+        return first;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    const Item& operator[](size_t i) const
+    {
+        return first[i];
+    }
+
+    template <typename Container>                                               // Оператор для сравнения с контейнером (строкой, вектором).
+    bool operator==(const Container& other) const
+    {
+        return count == other.size() &&
+               std::equal(begin(), end(), other.begin());
+    }
+
+private:
+    const Item* first;                                                          // Данные.
+    size_t count;                                                               // Количество элементов.
+};
+
+template <typename Item>
+class BlobSequence
+{
+public:
+    using value_type = BlobView<Item>;
+
+    size_t size() const
+    {
+        return ends.size();
+    }
+
+    bool empty() const
+    {
+        return ends.empty();
+    }
+
+    void clear()
+    {
+        ends.clear();
+        items.clear();
+    }
+
+    void reserve(size_t count, size_t total)                                    // Метод для резервирования памяти под count элементов
+    {                                                                           // с общим размером total.
+        ends.reserve(count);
+        items.reserve(total);
+    }
+
+    template <typename Container>                                               // Метод для добавления элемента (строки, вектора или
+    void push_back(const Container& item)                                       // BlobView).
+    {
+        if (item.size() > std::numeric_limits<uint32_t>::max() - items.size())
+        {
+            throw std::length_error("BlobSequence data exceeds 2^32 items.");
+        }
+        items.insert(items.end(), std::begin(item), std::end(item));
+        ends.push_back(static_cast<uint32_t>(items.size()));
+    }
+
+    BlobView<Item> operator[](size_t i) const
+    {
+        size_t begin = i ? ends[i - 1] : 0;
+        return BlobView<Item>(items.data() + begin, ends[i] - begin);
+    }
+
+    void load(std::vector<uint32_t> loaded_ends,                                // Метод для загрузки концов элементов и блока данных
+              std::vector<Item> loaded_items)                                   // (заменяет содержимое последовательности).
+    {
+        if (!valid_blob_ends(loaded_ends) ||
+            (loaded_ends.empty() ? 0 : loaded_ends.back()) !=
+                loaded_items.size())
+        {
+            throw std::invalid_argument("Invalid BlobSequence offsets.");
+        }
+        ends = std::move(loaded_ends);
+        items = std::move(loaded_items);
+    }
+
+    const std::vector<uint32_t>& offsets() const                                // Методы для получения концов элементов и блока данных.
+    {
+        return ends;
+    }
+
+    const std::vector<Item>& data() const
+    {
+        return items;
+    }
+
+    bool operator==(const BlobSequence& other) const
+    {
+        return ends == other.ends && items == other.items;
+    }
+
+    bool operator!=(const BlobSequence& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    std::vector<uint32_t> ends;                                                 // Концы элементов.
+    std::vector<Item> items;                                                    // Данные всех элементов.
+};
+
+template <typename>
+struct is_blob_sequence : std::false_type {};
+
+template <typename Item>
+struct is_blob_sequence<BlobSequence<Item>> : std::true_type {};
+
+template <typename Item>                                                        // Минимальный размер – префикс количества элементов.
+struct min_encoded_size<BlobSequence<Item>>
+    : std::integral_constant<uint64_t, sizeof(uint32_t)> {};
@@ -0,0 +1,129 @@
+/*  Шаблон columnar включает поколоночную сериализацию контейнеров
+    (вектор, дек, лист) пользовательских классов:
+
+        template <>
+        struct columnar<PodClass> : std::true_type {};
+
+    Каждое поле, сериализуемое в методе serialize класса (на верхнем
+    уровне, включая поля базовых классов), записывается в отдельную
+    колонку, а колонки – друг за другом после количества строк:
+    [количество строк][количество колонок][колонка 1]...[колонка N],
+    где колонка – строка с префиксом длины. Значения одного поля
+    хранятся в колонке непрерывно, что улучшает сжатие и позволяет
+    пропускать ненужные колонки по их длине.
+    При десериализации объекты собираются из колонок построчно.
+    Вложенные объекты и контейнеры полей сериализуются внутри своей
+    колонки обычным образом.
+*/
+
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "traits.h"
+#include "decoding_limits.h"
+
+template <typename T>                                                           // Признак поколоночной сериализации контейнеров объектов
+struct columnar : std::false_type {};                                           // класса T (по умолчанию выключена).
+
+template <typename T, typename Enable = void>                                   // Проверка на контейнер, сериализуемый по колонкам.
+struct is_columnar_container : std::false_type {};
+
+template <typename T>
+struct is_columnar_container<T, enable_if_t<is_std_vector<T>::value ||
+                                            is_std_deque<T>::value  ||
+                                            is_std_list<T>::value>>
+    : columnar<typename T::value_type> {};
+
+struct ColumnOutputBuffer                                                       // Буфер колонки для записи (используется вместо выходного
+{                                                                               // потока).
+    void write(const char* data, size_t size)
+    {
+        this->data.append(data, size);
+    }
+
+    bool operator!() const
+    {
+        return false;
+    }
+
+    std::string data;                                                           // Данные колонки.
+};
+
+struct ColumnInputBuffer                                                        // Буфер колонки для чтения (используется вместо входного
+{                                                                               // потока). Данные не копируются: буфер ссылается на строку
+    ColumnInputBuffer(const std::string& data)                                  // с прочитанной колонкой.
+        : cursor(data.data()), end(data.data() + data.size()) {}
+
+    ColumnInputBuffer()
+        : cursor(nullptr), end(nullptr) {}
+
+    void read(char* data, size_t size)                                          // Чтение за пределами колонки, как и для потока, приводит
+    {                                                                           // к ошибке (см. operator!).
+        if (size > size_t(end - cursor))
+        {
+            failed = true;
+            cursor = end;
+            return;
+        }
+        std::memcpy(data, cursor, size);
+        cursor += size;
+    }
+
+    bool operator!() const
+    {
+        return failed;
+    }
+
+    const char* cursor;                                                         // Текущая позиция чтения.
+    const char* end;                                                            // Конец колонки.
+    bool failed = false;                                                        // Признак чтения за пределами колонки.
+};
+
+template <>
+struct is_ostream<ColumnOutputBuffer> : std::true_type {};
+
+template <>
+struct is_istream<ColumnInputBuffer> : std::true_type {};
+
+template <typename Column>                                                      // Шаблон набора колонок, используемого вместо потока при
+struct Columns                                                                  // поколоночной сериализации: каждый вызов оператора & в методе
+{                                                                               // serialize объекта сериализует поле в очередную колонку.
+    using stream_type = Column;
+
+    Column& next()                                                              // Метод для получения колонки очередного поля (недостающие
+    {                                                                           // колонки создаются пустыми).
+        if (field == columns.size())
+        {
+            columns.emplace_back();
+        }
+        return columns[field++];
+    }
+
+    bool operator!() const                                                      // Оператор проверки состояния: true, если данные какой-либо
+    {                                                                           // колонки закончились раньше, чем ожидалось.
+        for (const auto& column : columns)
+        {
+            if (!column)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<Column> columns;                                                // Колонки.
+    size_t field = 0;                                                           // Номер колонки очередного поля в текущей строке.
+    DecodingLimits* limits = nullptr;                                           // Ограничения десериализации колонок (общие для всех колонок).
+};
+
+using ColumnOutput = Columns<ColumnOutputBuffer>;                               // Колонки для записи.
+using ColumnInput = Columns<ColumnInputBuffer>;                                 // Колонки для чтения.
+
+template <typename T>                                                           // Проверка на набор колонок.
+struct is_columns : std::false_type {};
+
+template <typename Column>
+struct is_columns<Columns<Column>> : std::true_type {};
\ No newline at end of file
@@ -0,0 +1,115 @@
+/*  Структура DecodingLimits ограничивает память, выделяемую при
+    десериализации, и проверяет размеры контейнеров, прочитанные
+    из потока, до выделения памяти под них: заявленный размер
+    не может превышать количество оставшихся во входном потоке данных
+    (если размер потока известен), а суммарный объем выделенной
+    памяти – бюджет архива.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "traits.h"
+#include "access.h"
+#include "status.h"
+#include "fixed_layout.h"
+
+template <typename T, typename Enable = void>                                   // Минимальный размер сериализованного объекта типа T в байтах:
+struct min_encoded_size                                                         // (1) по умолчанию – размер, известный на этапе компиляции
+    : std::integral_constant<uint64_t, fixed_layout<T>::size> {};               //     (см. fixed_layout.h), или 0, если он неизвестен (например,
+                                                                                //     для классов с методом serialize, который может ничего
+                                                                                //     не записывать);
+template <typename T>                                                           // (2) для фундаментальных типов – их размер;
+struct min_encoded_size<T, enable_if_t<std::is_fundamental<T>::value>>
+    : std::integral_constant<uint64_t, sizeof(T)> {};
+
+template <typename T>                                                           // (3) для контейнеров – размер префикса длины;
+struct min_encoded_size<T, enable_if_t<is_iterable<T>::value &&
+                                       !is_std_array<T>::value>>
+    : std::integral_constant<uint64_t, sizeof(uint32_t)> {};
+
+template <typename T, size_t N>                                                 // (4) для статических массивов – префикс длины и N элементов
+struct min_encoded_size<std::array<T, N>>                                       //     (префикса нет, если размер массива известен на этапе
+    : std::integral_constant<uint64_t,                                          //     компиляции);
+        fixed_layout<std::array<T, N>>::value ?
+            fixed_layout<std::array<T, N>>::size :
+            sizeof(uint32_t) + N * min_encoded_size<T>::value> {};
+
+template <typename First, typename Second>                                      // (5) для пар – сумма размеров элементов;
+struct min_encoded_size<std::pair<First, Second>>
+    : std::integral_constant<uint64_t, min_encoded_size<First>::value +
+                                       min_encoded_size<Second>::value> {};
+
+template <typename T>                                                           // (6) для служебной структуры Pointer – индикатор пустого
+struct min_encoded_size<Pointer<T>>                                             //     указателя.
+    : std::integral_constant<uint64_t, sizeof(bool)> {};
+
+template <size_t N>                                                             // (7) для std::bitset – упакованные биты.
+struct min_encoded_size<std::bitset<N>>
+    : std::integral_constant<uint64_t, (N + 7) / 8> {};
+
+struct DecodingLimits
+{
+    static const uint64_t unknown = std::numeric_limits<uint64_t>::max();       // Признак неизвестного размера входного потока.
+    static const size_t growth_step = 1 << 16;                                  // Шаг (в байтах), которым растут векторы и строки, если
+                                                                                // заявленный размер нельзя проверить по размеру потока.
+    template <typename T>                                                       // Метод для проверки заявленного количества элементов типа T
+    Status claim(uint64_t count, bool& verified,                                // перед выделением памяти под них: возвращает код ошибки, если
+                 uint64_t min_size = min_encoded_size<T>::value)                // оставшихся данных заведомо не хватает или превышен бюджет.
+    {                                                                           // verified – признак того, что размер подтвержден размером
+        verified = false;                                                       // потока (и память можно выделить сразу целиком); min_size –
+                                                                                // минимальный размер элемента в потоке (если он отличается
+                                                                                // от обычного, например, для упакованных ключей).
+
+        if (min_size && input_size != unknown)
+        {
+            if (count > remaining() / min_size)
+            {
+                return Status::InputTooShort;
+            }
+            verified = true;
+        }
+
+        if (count > (memory_budget - memory_used) / sizeof(T))
+        {
+            return Status::BudgetExceeded;
+        }
+
+        memory_used += count * sizeof(T);
+        return Status::Ok;
+    }
+
+    uint64_t remaining() const                                                  // Метод для получения количества оставшихся в потоке данных.
+    {
+        return consumed < input_size ? input_size - consumed : 0;
+    }
+
+    std::string describe(Status status, uint64_t count) const                   // Метод для формирования сообщения об ошибке проверки размера.
+    {
+        std::ostringstream os;
+        os << "Claimed size " << count;
+
+        if (status == Status::InputTooShort)
+        {
+            os << " exceeds remaining input (" << remaining() << " bytes).";
+        }
+        else
+        {
+            os << " exceeds memory budget (" << memory_budget - memory_used
+               << " of " << memory_budget << " bytes left).";
+        }
+
+        os << " Deserialization failed.";
+        return os.str();
+    }
+                                                                                // Поля:
+    uint64_t memory_budget = std::numeric_limits<uint64_t>::max();              // - бюджет памяти архива (по умолчанию не ограничен);
+    uint64_t memory_used = 0;                                                   // - объем памяти, выделенной при десериализации;
+    uint64_t input_size = unknown;                                              // - размер входного потока (от позиции создания архива);
+    uint64_t consumed = 0;                                                      // - объем прочитанных из потока данных.
+};
\ No newline at end of file
@@ -0,0 +1,196 @@
+/*  Кэш кодирования неизменяемых вложенных объектов.
+    Шаблон класса Memoized<T> – поле с разделяемым объектом T и номером
+    его версии, который увеличивает пользователь при изменении объекта:
+
+        struct Quote
+        {
+            int id;
+            Memoized<ReferenceTable> table;
+            ...
+        };
+
+        EncodingCache cache;
+        Archive<std::ostringstream> oa(output);
+        oa.set_encoding_cache(&cache);
+        oa << quote;
+
+    Если архиву задан кэш (класс EncodingCache), при первой записи
+    объекта его сериализованное представление сохраняется в кэше по
+    адресу объекта, а при следующих записях той же версии копируется в
+    поток без повторной сериализации. Формат данных не меняется: поле
+    записывается так же, как объект T, и читается без кэша (при чтении
+    создается новый объект версии 0).
+    Запись устаревает, если изменился номер версии, параметры
+    кодирования архива или объект был удален. Поля, сериализуемые при
+    включенном словаре строк или таблице разделяемых объектов, не
+    кэшируются: их представление зависит от состояния архива.
+    Кэш не синхронизирован: его нельзя использовать из нескольких потоков
+    одновременно.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "encoding_options.h"
+#include "pointer_table.h"
+
+template <typename T>
+class Memoized
+{
+public:
+    Memoized() : object(std::make_shared<T>()) {}                               // Конструктор по умолчанию – новый объект версии 0.
+
+    explicit Memoized(std::shared_ptr<T> object, uint64_t version = 0)          // Конструктор с разделяемым объектом и номером его версии.
+        : object(std::move(object)), generation(version)
+    {
+        if (!this->object)
+        {
+            throw std::invalid_argument("Memoized object must not be null.");
+        }
+    }
+
+    const T& operator*() const
+    {
+        return *object;
+    }
+
+    const T* operator->() const
+    {
+        return object.get();
+    }
+
+    const std::shared_ptr<T>& shared() const                                    // Метод для получения разделяемого объекта.
+    {
+        return object;
+    }
+
+    uint64_t version() const
+    {
+        return generation;
+    }
+
+    void set_version(uint64_t version)                                          // Метод для задания номера версии (после изменения объекта
+    {                                                                           // через разделяемый указатель).
+        generation = version;
+    }
+
+private:
+    std::shared_ptr<T> object;                                                  // Объект.
+    uint64_t generation = 0;                                                    // Номер версии объекта.
+};
+
+class EncodingCache
+{
+public:
+    template <typename T>                                                       // Метод для поиска сериализованного представления объекта
+    const std::string* find(const std::shared_ptr<T>& object,                   // версии version, записанного с параметрами options.
+                            uint64_t version,                                   // Возвращает nullptr, если записи нет или она устарела.
+                            const EncodingOptions& options)
+    {
+        auto it = entries.find(key(object));
+        if (it == entries.end() || !valid(it->second, object, version,
+                                          options))
+        {
+            misses++;
+            return nullptr;
+        }
+        hits++;
+        return &it->second.data;
+    }
+
+    template <typename T>                                                       // Метод для сохранения сериализованного представления
+    const std::string& store(const std::shared_ptr<T>& object,                  // объекта (заменяет устаревшую запись).
+                             uint64_t version,
+                             const EncodingOptions& options,
+                             std::string data)
+    {
+        Entry& entry = entries[key(object)];
+        stored_bytes += data.size() - entry.data.size();
+        entry.object = object;
+        entry.version = version;
+        entry.options = options;
+        entry.data = std::move(data);
+        return entry.data;
+    }
+
+    void prune()                                                                // Метод для удаления записей удаленных объектов.
+    {
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            if (it->second.object.expired())
+            {
+                stored_bytes -= it->second.data.size();
+                it = entries.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void clear()
+    {
+        entries.clear();
+        stored_bytes = 0;
+    }
+
+    size_t size() const                                                         // Методы для получения количества записей, их общего
+    {                                                                           // размера в байтах и количества попаданий и промахов.
+        return entries.size();
+    }
+
+    size_t bytes() const
+    {
+        return stored_bytes;
+    }
+
+    size_t hit_count() const
+    {
+        return hits;
+    }
+
+    size_t miss_count() const
+    {
+        return misses;
+    }
+
+private:
+    using Key = std::pair<const void*, const void*>;                            // Ключ записи: адрес объекта и метка типа.
+
+    struct Entry                                                                // Запись кэша.
+    {                                                                           // Поля:
+        std::weak_ptr<const void> object;                                       // - объект (для проверки, что он не удален);
+        uint64_t version = 0;                                                   // - номер версии;
+        EncodingOptions options;                                                // - параметры кодирования;
+        std::string data;                                                       // - сериализованное представление.
+    };
+
+    template <typename T>
+    static Key key(const std::shared_ptr<T>& object)
+    {
+        return Key(object.get(), pointer_type_tag<T>());
+    }
+
+    template <typename T>                                                       // Функция для проверки актуальности записи: объект
+    static bool valid(const Entry& entry, const std::shared_ptr<T>& object,     // не удален (по адресу не создан другой объект), версия
+                      uint64_t version, const EncodingOptions& options)         // и параметры кодирования не изменились.
+    {
+        return entry.version == version &&
+               entry.options.packed_keys == options.packed_keys &&
+               entry.options.compressed_floats == options.compressed_floats &&
+               entry.options.blob_layout == options.blob_layout &&
+               entry.object.lock() == std::shared_ptr<const void>(object);
+    }
+
+    std::map<Key, Entry> entries;                                               // Записи.
+    size_t stored_bytes = 0;                                                    // Общий размер записей.
+    size_t hits = 0;                                                            // Количество попаданий.
+    size_t misses = 0;                                                          // Количество промахов.
+};
\ No newline at end of file
@@ -0,0 +1,16 @@
+/*  Структура EncodingOptions содержит параметры кодирования архива,
+    которые меняют формат сериализованных данных. Параметры
+    задаются методами Archive и должны совпадать при сериализации
+    и десериализации.
+*/
+
+#pragma once
+
+struct EncodingOptions
+{                                                                               // Поля:
+    bool packed_keys = false;                                                   // - упаковка целочисленных ключей упорядоченных
+                                                                                //   ассоциативных контейнеров (см. bit_packing.h);
+    bool compressed_floats = false;                                             // - сжатие последовательностей чисел с плавающей точкой
+                                                                                //   (см. float_compression.h);
+    bool blob_layout = false;                                                   // - раскладка «смещения и блок данных» для векторов строк
+};                                                                              //   и векторов векторов (см. blob_layout.h).
\ No newline at end of file
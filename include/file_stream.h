@@ -0,0 +1,677 @@
+/*  Классы FileSink и FileSource – файловые приемник и источник данных
+    для архива (используются вместо std::ofstream и std::ifstream):
+
+        FileSink sink("snapshot.bin");
+        Archive<FileSink> oa(sink);
+
+    Данные копируются в несколько больших выровненных буферов; заполненный
+    буфер отправляется на запись асинхронно (через io_uring), и
+    сериализация продолжается в следующий буфер, пока ядро записывает
+    предыдущие. Источник аналогично заранее читает несколько следующих
+    буферов файла (первые запросы отправляются одним пакетом).
+    Если io_uring недоступен (не Linux, старое ядро, запрет системного
+    вызова), используются синхронные pwrite/pread. Незавершенная или
+    неудачная асинхронная операция дозавершается синхронно; после ошибки
+    отправки операций в очередь используется синхронный режим.
+    Ошибки ввода-вывода приводят к исключениям std::runtime_error.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "traits.h"
+
+#if defined(__linux__) && defined(__has_include)                                // io_uring используется без liburing – только заголовок ядра
+#if __has_include(<linux/io_uring.h>)                                           // и системные вызовы.
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define SERIALIZATION_IO_URING
+#endif
+#endif
+
+class IoUring                                                                   // Класс минимальной очереди io_uring: чтение и запись
+{                                                                               // по смещению и ожидание завершения операций.
+public:
+    IoUring() = default;
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    ~IoUring()
+    {
+        close();
+    }
+
+    bool open(unsigned entries)                                                 // Метод для создания очереди на entries операций.
+    {                                                                           // Возвращает false, если io_uring недоступен.
+#ifdef SERIALIZATION_IO_URING
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+
+        int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0)
+        {
+            return false;
+        }
+        ring_fd = fd;
+
+        sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single)                                                             // Кольца отправки и завершения могут отображаться одним
+        {                                                                       // вызовом mmap.
+            sq_size = cq_size = std::max(sq_size, cq_size);
+        }
+
+        sq_ring = map(sq_size, IORING_OFF_SQ_RING);
+        cq_ring = single ? sq_ring : map(cq_size, IORING_OFF_CQ_RING);
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(map(sqes_size, IORING_OFF_SQES));
+
+        if (!sq_ring || !cq_ring || !sqes)
+        {
+            close();
+            return false;
+        }
+
+        char* sq = static_cast<char*>(sq_ring);
+        char* cq = static_cast<char*>(cq_ring);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+#else
+        (void)entries;
+        return false;
+#endif
+    }
+
+    void write(int fd, const char* data, size_t size,                           // Методы для добавления в очередь записи и чтения по
+               uint64_t offset, uint64_t id)                                    // смещению offset (id – идентификатор операции).
+    {                                                                           // Операции отправляются методом submit.
+#ifdef SERIALIZATION_IO_URING
+        push(IORING_OP_WRITE, fd, const_cast<char*>(data), size, offset, id);
+#endif
+    }
+
+    void read(int fd, char* data, size_t size, uint64_t offset, uint64_t id)
+    {
+#ifdef SERIALIZATION_IO_URING
+        push(IORING_OP_READ, fd, data, size, offset, id);
+#endif
+    }
+
+    bool submit()                                                               // Метод для отправки добавленных операций одним пакетом.
+    {
+#ifdef SERIALIZATION_IO_URING
+        while (pending)
+        {
+            int submitted = static_cast<int>(
+                syscall(__NR_io_uring_enter, ring_fd, pending, 0, 0, nullptr, 0));
+            if (submitted < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            pending -= submitted;
+        }
+#endif
+        return true;
+    }
+
+    size_t unsubmitted() const                                                  // Метод для получения количества добавленных, но не
+    {                                                                           // отправленных операций (последних добавленных).
+#ifdef SERIALIZATION_IO_URING
+        return pending;
+#else
+        return 0;
+#endif
+    }
+
+    bool wait(uint64_t& id, int& result)                                        // Метод для ожидания завершения очередной операции:
+    {                                                                           // id – идентификатор, result – результат системного вызова
+#ifdef SERIALIZATION_IO_URING                                                   // (количество байт или -errno).
+        unsigned head = *cq_head;
+        while (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))
+        {
+            if (syscall(__NR_io_uring_enter, ring_fd, 0, 1,
+                        IORING_ENTER_GETEVENTS, nullptr, 0) < 0 &&
+                errno != EINTR)
+            {
+                return false;
+            }
+        }
+
+        const io_uring_cqe& cqe = cqes[head & cq_mask];
+        id = cqe.user_data;
+        result = cqe.res;
+        __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+        return true;
+#else
+        (void)id;
+        (void)result;
+        return false;
+#endif
+    }
+
+    void close()                                                                // Метод для закрытия очереди (добавленные, но
+    {                                                                           // не отправленные операции отбрасываются).
+#ifdef SERIALIZATION_IO_URING
+        if (sqes)
+        {
+            munmap(sqes, sqes_size);
+        }
+        if (cq_ring && cq_ring != sq_ring)
+        {
+            munmap(cq_ring, cq_size);
+        }
+        if (sq_ring)
+        {
+            munmap(sq_ring, sq_size);
+        }
+        sqes = nullptr;
+        sq_ring = cq_ring = nullptr;
+        pending = 0;
+#endif
+        if (ring_fd >= 0)
+        {
+            ::close(ring_fd);
+            ring_fd = -1;
+        }
+    }
+
+private:
+#ifdef SERIALIZATION_IO_URING
+    void* map(size_t size, off_t offset)                                        // Метод для отображения области очереди в память.
+    {
+        void* area = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+        return area == MAP_FAILED ? nullptr : area;
+    }
+
+    void push(uint8_t opcode, int fd, char* data, size_t size,                  // Метод для добавления операции в кольцо отправки
+              uint64_t offset, uint64_t id)                                     // (количество операций в полете не превышает размер
+    {                                                                           // очереди – это обеспечивают FileSink и FileSource).
+        unsigned tail = *sq_tail;
+        unsigned index = tail & sq_mask;
+
+        io_uring_sqe& sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uint64_t>(data);
+        sqe.len = static_cast<unsigned>(size);
+        sqe.off = offset;
+        sqe.user_data = id;
+
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        pending++;
+    }
+#endif
+
+    int ring_fd = -1;                                                           // Дескриптор очереди.
+#ifdef SERIALIZATION_IO_URING
+    void* sq_ring = nullptr;                                                    // Отображенные кольца отправки и завершения
+    void* cq_ring = nullptr;                                                    // и их размеры.
+    size_t sq_size = 0;
+    size_t cq_size = 0;
+    io_uring_sqe* sqes = nullptr;                                               // Массив операций и его размер.
+    size_t sqes_size = 0;
+    unsigned* sq_tail = nullptr;                                                // Указатели на поля колец.
+    unsigned* sq_array = nullptr;
+    unsigned sq_mask = 0;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+    unsigned pending = 0;                                                       // Количество неотправленных операций.
+#endif
+};
+
+struct FileBuffer                                                               // Буфер файлового приемника или источника.
+{                                                                               // Поля:
+    char* data = nullptr;                                                       // - выровненные данные;
+    size_t size = 0;                                                            // - количество данных в буфере;
+    size_t position = 0;                                                        // - позиция чтения (для источника);
+    uint64_t offset = 0;                                                        // - смещение данных буфера в файле;
+    bool busy = false;                                                          // - признак асинхронной операции с буфером.
+};
+
+class FileBuffers                                                               // Базовый класс файлового приемника и источника: файл,
+{                                                                               // буферы и очередь io_uring.
+public:
+    static const size_t alignment = 4096;                                       // Выравнивание буферов (размер страницы).
+
+    FileBuffers(const FileBuffers&) = delete;
+    FileBuffers& operator=(const FileBuffers&) = delete;
+
+    bool asynchronous() const                                                   // Метод для проверки использования io_uring.
+    {
+        return async;
+    }
+
+    bool operator!() const                                                      // Оператор проверки состояния (как у потока): true, если
+    {                                                                           // данные в источнике закончились раньше, чем ожидалось.
+        return failed;
+    }
+
+protected:
+    FileBuffers(const std::string& path, int flags, size_t buffer_size,         // Конструктор: открывает файл и выделяет буферы.
+                size_t buffer_count, bool use_io_uring)
+        : buffer_size(buffer_size)
+    {
+        if (!buffer_size || !buffer_count)
+        {
+            throw std::invalid_argument("File buffer size and count must be "
+                                        "positive.");
+        }
+
+        fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            fail_io("open");
+        }
+
+        buffers.resize(buffer_count);
+        for (auto& buffer : buffers)
+        {
+            void* data = nullptr;
+            if (posix_memalign(&data, alignment, buffer_size))
+            {
+                release();
+                throw std::bad_alloc();
+            }
+            buffer.data = static_cast<char*>(data);
+        }
+
+        async = use_io_uring && ring.open(static_cast<unsigned>(buffer_count));
+    }
+
+    ~FileBuffers()
+    {
+        release();
+    }
+
+    void complete()                                                             // Метод для ожидания завершения очередной асинхронной
+    {                                                                           // операции (недописанные или недочитанные данные
+        uint64_t id = 0;                                                        // обрабатываются синхронно).
+        int result = 0;
+        if (!ring.wait(id, result))
+        {
+            fail_io("io_uring_enter");
+        }
+
+        FileBuffer& buffer = buffers[id];
+        buffer.busy = false;
+        completed(buffer, result < 0 ? 0 : size_t(result));
+    }
+
+    virtual void completed(FileBuffer& buffer, size_t done) = 0;                // Метод для обработки завершения операции с буфером.
+
+    void drain()                                                                // Метод для ожидания завершения всех асинхронных операций
+    {                                                                           // без обработки результатов (перед освобождением буферов
+        for (auto& buffer : buffers)                                            // после ошибки).
+        {
+            while (buffer.busy)
+            {
+                uint64_t id = 0;
+                int result = 0;
+                if (!ring.wait(id, result))
+                {
+                    return;
+                }
+                buffers[id].busy = false;
+            }
+        }
+    }
+
+    bool release()                                                              // Метод для освобождения буферов и закрытия файла.
+    {                                                                           // Буферы незавершенных операций не освобождаются (ядро
+        for (auto& buffer : buffers)                                            // еще может обращаться к ним). Возвращает false при
+        {                                                                       // ошибке закрытия файла.
+            if (!buffer.busy)
+            {
+                std::free(buffer.data);
+                buffer.data = nullptr;
+            }
+        }
+
+        bool closed = true;
+        if (fd >= 0)
+        {
+            closed = !::close(fd) || errno == EINTR;
+            fd = -1;
+        }
+        return closed;
+    }
+
+    [[noreturn]] static void fail_io(const char* operation)                     // Функция для сообщения об ошибке ввода-вывода.
+    {
+        throw std::runtime_error(std::string("File ") + operation +
+                                 " failed: " + std::strerror(errno));
+    }
+
+    int fd = -1;                                                                // Дескриптор файла.
+    size_t buffer_size;                                                         // Размер буфера.
+    std::vector<FileBuffer> buffers;                                            // Буферы.
+    size_t current = 0;                                                         // Номер текущего буфера.
+    IoUring ring;                                                               // Очередь io_uring.
+    bool async = false;                                                         // Признак использования io_uring.
+    bool failed = false;                                                        // Признак нехватки данных (для источника).
+};
+
+class FileSink : public FileBuffers                                             // Файловый приемник данных.
+{
+public:
+    FileSink(const std::string& path, size_t buffer_size = 1 << 20,             // Конструктор: создает (перезаписывает) файл path.
+             size_t buffer_count = 4, bool use_io_uring = true)
+        : FileBuffers(path, O_WRONLY | O_CREAT | O_TRUNC, buffer_size,
+                      buffer_count, use_io_uring) {}
+
+    ~FileSink()
+    {
+        try
+        {
+            close();
+        }
+        catch (...)                                                             // Деструктор не выбрасывает исключений: для обработки
+        {                                                                       // ошибок записи и закрытия нужно вызывать close() явно.
+        }
+    }
+
+    void write(const char* data, size_t size)                                   // Метод для записи данных (интерфейс потока).
+    {
+        while (size)
+        {
+            FileBuffer& buffer = buffers[current];
+            size_t take = std::min(size, buffer_size - buffer.size);
+            std::memcpy(buffer.data + buffer.size, data, take);
+            buffer.size += take;
+            data += take;
+            size -= take;
+
+            if (buffer.size == buffer_size)
+            {
+                flush();
+            }
+        }
+    }
+
+    void close()                                                                // Метод для записи оставшихся данных и закрытия файла.
+    {                                                                           // При ошибке записи или закрытия файл все равно
+        if (fd < 0)                                                             // закрывается, а ошибка выбрасывается.
+        {
+            return;
+        }
+
+        try
+        {
+            if (buffers[current].size)
+            {
+                flush();
+            }
+
+            for (auto& buffer : buffers)                                        // Дожидаемся завершения всех операций.
+            {
+                while (buffer.busy)
+                {
+                    complete();
+                }
+            }
+        }
+        catch (...)
+        {
+            drain();
+            release();
+            throw;
+        }
+
+        if (!release())
+        {
+            fail_io("close");
+        }
+    }
+
+    static uint64_t input_size()                                                // Размер входных данных (для архива): неизвестен.
+    {
+        return std::numeric_limits<uint64_t>::max();
+    }
+
+private:
+    void flush()                                                                // Метод для отправки текущего буфера на запись и перехода
+    {                                                                           // к следующему (ожидая его освобождения).
+        FileBuffer& buffer = buffers[current];
+        buffer.offset = offset;
+        offset += buffer.size;
+
+        if (async)
+        {
+            ring.write(fd, buffer.data, buffer.size, buffer.offset, current);
+            buffer.busy = true;
+            if (!ring.submit())                                                 // Ошибка отправки: дожидаемся отправленных ранее операций
+            {                                                                   // и закрываем очередь (неотправленная операция не должна
+                buffer.busy = false;                                            // выполниться после повторного использования буфера),
+                async = false;                                                  // дальше запись синхронная.
+                for (auto& other : buffers)
+                {
+                    while (other.busy)
+                    {
+                        complete();
+                    }
+                }
+                ring.close();
+                completed(buffer, 0);
+            }
+        }
+        else
+        {
+            completed(buffer, 0);
+        }
+
+        current = (current + 1) % buffers.size();
+        while (buffers[current].busy)
+        {
+            complete();
+        }
+    }
+
+    void completed(FileBuffer& buffer, size_t done) override                    // Метод для синхронной записи оставшейся части буфера.
+    {
+        while (done < buffer.size)
+        {
+            ssize_t written = pwrite(fd, buffer.data + done, buffer.size - done,
+                                     buffer.offset + done);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                fail_io("write");
+            }
+            done += size_t(written);
+        }
+        buffer.size = 0;
+    }
+
+    uint64_t offset = 0;                                                        // Смещение следующего буфера в файле.
+};
+
+class FileSource : public FileBuffers                                           // Файловый источник данных.
+{
+public:
+    FileSource(const std::string& path, size_t buffer_size = 1 << 20,           // Конструктор: открывает файл path и отправляет запросы
+               size_t buffer_count = 4, bool use_io_uring = true)               // на чтение первых буферов одним пакетом.
+        : FileBuffers(path, O_RDONLY, buffer_size, buffer_count, use_io_uring)
+    {
+        struct stat info;
+        if (fstat(fd, &info))
+        {
+            fail_io("stat");
+        }
+        file_size = static_cast<uint64_t>(info.st_size);
+
+        for (size_t i = 0; i < buffers.size(); i++)
+        {
+            schedule(buffers[i], i);
+        }
+        submit();
+    }
+
+    ~FileSource()
+    {
+        drain();                                                                // Буферы нельзя освобождать до завершения операций.
+    }
+
+    void read(char* data, size_t size)                                          // Метод для чтения данных (интерфейс потока).
+    {
+        while (size)
+        {
+            FileBuffer& buffer = buffers[current];
+            while (buffer.busy)
+            {
+                complete();
+            }
+
+            if (buffer.position == buffer.size)                                // Данные файла закончились.
+            {
+                failed = true;
+                return;
+            }
+
+            size_t take = std::min(size, buffer.size - buffer.position);
+            std::memcpy(data, buffer.data + buffer.position, take);
+            buffer.position += take;
+            position += take;
+            data += take;
+            size -= take;
+
+            if (buffer.position == buffer.size)                                 // Буфер прочитан: запрашиваем в него следующую часть
+            {                                                                   // файла и переходим к следующему буферу.
+                schedule(buffer, current);
+                submit();
+                current = (current + 1) % buffers.size();
+            }
+        }
+    }
+
+    uint64_t input_size() const                                                 // Количество непрочитанных данных (для архива).
+    {
+        return file_size - position;
+    }
+
+private:
+    void schedule(FileBuffer& buffer, size_t index)                             // Метод для запроса чтения следующей части файла в буфер.
+    {
+        buffer.offset = next_offset;
+        buffer.size = std::min<uint64_t>(buffer_size, file_size - next_offset);
+        buffer.position = 0;
+        next_offset += buffer.size;
+
+        if (!buffer.size)
+        {
+            return;
+        }
+
+        if (async)
+        {
+            ring.read(fd, buffer.data, buffer.size, buffer.offset, index);
+            buffer.busy = true;
+            unsent.push_back(index);
+        }
+        else
+        {
+            completed(buffer, 0);
+        }
+    }
+
+    void submit()                                                               // Метод для отправки запросов на чтение. При ошибке
+    {                                                                           // дожидаемся отправленных ранее операций и закрываем
+        if (!async)                                                             // очередь (неотправленная операция не должна выполниться
+        {                                                                       // после повторного использования буфера), неотправленные
+            return;                                                             // буферы дочитываются синхронно, дальше чтение
+        }                                                                       // синхронное.
+
+        if (ring.submit())
+        {
+            unsent.clear();
+            return;
+        }
+
+        std::vector<size_t> rest(unsent.end() - ring.unsubmitted(),
+                                 unsent.end());
+        unsent.clear();
+        for (size_t index : rest)
+        {
+            buffers[index].busy = false;
+        }
+        async = false;
+        for (auto& buffer : buffers)
+        {
+            while (buffer.busy)
+            {
+                complete();
+            }
+        }
+        ring.close();
+        for (size_t index : rest)
+        {
+            completed(buffers[index], 0);
+        }
+    }
+
+    void completed(FileBuffer& buffer, size_t done) override                    // Метод для синхронного чтения оставшейся части буфера.
+    {
+        while (done < buffer.size)
+        {
+            ssize_t count = pread(fd, buffer.data + done, buffer.size - done,
+                                  buffer.offset + done);
+            if (count < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                fail_io("read");
+            }
+            if (!count)                                                         // Файл укоротился во время чтения.
+            {
+                buffer.size = done;
+                break;
+            }
+            done += size_t(count);
+        }
+    }
+
+    uint64_t file_size = 0;                                                     // Размер файла.
+    uint64_t next_offset = 0;                                                   // Смещение следующей запрашиваемой части файла.
+    uint64_t position = 0;                                                      // Количество прочитанных данных.
+    std::vector<size_t> unsent;                                                 // Номера буферов с неотправленными операциями.
+};
+
+template <>
+struct is_ostream<FileSink> : std::true_type {};
+
+template <>
+struct is_istream<FileSource> : std::true_type {};
\ No newline at end of file
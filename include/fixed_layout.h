@@ -0,0 +1,157 @@
+/*  Шаблон fixed_layout определяет типы, размер сериализованного
+    представления которых известен на этапе компиляции: фундаментальные
+    типы, статические массивы и пары таких типов, а также пользовательские
+    классы, для которых объявлен состав сериализуемых полей:
+
+        template <>
+        struct fixed_layout<PodClass>
+            : FixedLayout<int, char, uint32_t, int64_t> {};
+
+    Типы полей должны совпадать с полями, сериализуемыми в методе
+    serialize класса (в том же порядке).
+    Такие объекты сериализуются без префикса длины: при записи и чтении
+    выполняется одна проверка границ потока для всего объекта, а поля
+    копируются в буфер на стеке и из него (FixedOutputBuffer и
+    FixedInputBuffer используются вместо потоков). Буферы не выходят
+    за свои границы: если метод serialize записывает или читает больше
+    или меньше объявленного, сериализация завершается ошибкой
+    Status::InvalidData.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+#include "traits.h"
+
+template <typename T, typename Enable = void>                                   // Шаблон структуры с признаком фиксированного размера
+struct fixed_layout                                                             // (value) и, непосредственно, размером (size) сериализованного
+{                                                                               // представления типа T. По умолчанию размер неизвестен.
+    static const bool value = false;
+    static const size_t size = 0;
+};
+
+template <typename... Fields>                                                   // Шаблон структуры для объявления состава полей
+struct FixedLayout;                                                             // пользовательского класса с фиксированным размером.
+
+template <>
+struct FixedLayout<>
+{
+    static const bool value = true;
+    static const size_t size = 0;
+};
+
+template <typename Field, typename... Fields>                                   // Размер класса – сумма размеров полей; класс имеет
+struct FixedLayout<Field, Fields...>                                            // фиксированный размер, только если его имеют все поля.
+{
+    static const bool value = fixed_layout<Field>::value &&
+                              FixedLayout<Fields...>::value;
+    static const size_t size = fixed_layout<Field>::size +
+                               FixedLayout<Fields...>::size;
+};
+
+template <typename T>                                                           // Фундаментальные (арифметические) типы.
+struct fixed_layout<T, enable_if_t<std::is_arithmetic<T>::value>>
+{
+    static const bool value = true;
+    static const size_t size = sizeof(T);
+};
+
+template <typename T, size_t N>                                                 // Статические массивы элементов фиксированного размера
+struct fixed_layout<std::array<T, N>>                                           // (пустые массивы сериализуются как обычные контейнеры).
+{
+    static const bool value = fixed_layout<T>::value && N > 0;
+    static const size_t size = value ? N * fixed_layout<T>::size : 0;
+};
+
+template <typename First, typename Second>                                      // Пары элементов фиксированного размера.
+struct fixed_layout<std::pair<First, Second>>
+    : FixedLayout<First, Second> {};
+
+template <typename T>                                                           // Функция для получения размера сериализованного
+constexpr size_t serialized_size()                                              // представления типа T на этапе компиляции.
+{
+    return fixed_layout<T>::size;
+}
+
+template <typename T>                                                           // Проверка на составной тип фиксированного размера
+struct is_fixed_layout                                                          // (статический массив или пользовательский класс), который
+    : std::integral_constant<bool, fixed_layout<T>::value &&                    // сериализуется без префикса длины за одну проверку границ.
+                                   !std::is_arithmetic<T>::value &&
+                                   !is_std_pair<T>::value> {};
+
+struct FixedOutputBuffer                                                        // Буфер для записи объекта фиксированного размера.
+{                                                                               // Используется вместо выходного потока: границы потока
+    FixedOutputBuffer(char* data, size_t size)                                  // проверяются один раз перед записью буфера в поток.
+        : cursor(data), end(data + size) {}
+
+    void write(const char* data, size_t size)                                   // Запись за концом буфера не выполняется, а отмечается
+    {                                                                           // флагом переполнения.
+        if (size > size_t(end - cursor))
+        {
+            overflow = true;
+            return;
+        }
+        std::memcpy(cursor, data, size);
+        cursor += size;
+    }
+
+    bool operator!() const
+    {
+        return overflow;
+    }
+
+    char* cursor;                                                               // Текущая позиция записи.
+    char* end;                                                                  // Конец буфера.
+    bool overflow = false;                                                      // Признак попытки записи за концом буфера.
+};
+
+struct FixedInputBuffer                                                         // Буфер для чтения объекта фиксированного размера.
+{                                                                               // Используется вместо входного потока после того, как данные
+    FixedInputBuffer(const char* data, size_t size)                             // объекта целиком прочитаны из потока.
+        : cursor(data), end(data + size) {}
+
+    void read(char* data, size_t size)                                          // Чтение за концом буфера не выполняется, а отмечается
+    {                                                                           // флагом переполнения.
+        if (size > size_t(end - cursor))
+        {
+            overflow = true;
+            return;
+        }
+        std::memcpy(data, cursor, size);
+        cursor += size;
+    }
+
+    bool operator!() const
+    {
+        return overflow;
+    }
+
+    const char* cursor;                                                         // Текущая позиция чтения.
+    const char* end;                                                            // Конец буфера.
+    bool overflow = false;                                                      // Признак попытки чтения за концом буфера.
+};
+
+template <>
+struct is_ostream<FixedOutputBuffer> : std::true_type {};
+
+template <>
+struct is_istream<FixedInputBuffer> : std::true_type {};
+
+template <typename T>                                                           // Тип элемента статического массива (для остальных типов –
+struct array_element                                                            // сам тип).
+{
+    using type = T;
+};
+
+template <typename T, size_t N>
+struct array_element<std::array<T, N>>
+{
+    using type = T;
+};
+
+template <typename T>                                                           // Проверка на буфер объекта фиксированного размера.
+struct is_fixed_buffer
+    : std::integral_constant<bool, std::is_same<T, FixedOutputBuffer>::value ||
+                                   std::is_same<T, FixedInputBuffer>::value> {};
\ No newline at end of file
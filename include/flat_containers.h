@@ -0,0 +1,281 @@
+/*  Шаблоны классов FlatSet и FlatMap – упорядоченные ассоциативные
+    контейнеры на основе отсортированного вектора (аналоги std::set и
+    std::map). Элементы хранятся в памяти непрерывно, поэтому поиск –
+    двоичный поиск по массиву без переходов по указателям узлов дерева,
+    а обход – последовательное чтение памяти. Вставка и удаление в
+    середине контейнера требуют сдвига элементов, поэтому контейнеры
+    предназначены для данных, которые в основном читаются (например,
+    после десериализации).
+    Формат сериализации совпадает с std::set и std::map (включая
+    упаковку ключей): архив, записанный из std::map, читается в FlatMap
+    и наоборот. При чтении элементы загружаются в вектор одним блоком;
+    упорядоченные данные (так их записывают std::set и std::map)
+    загружаются за линейное время, иначе элементы сортируются, а
+    повторяющиеся ключи отбрасываются (остается первый, как при
+    вставке в std::map).
+    Ключи нельзя изменять через итераторы: это нарушит порядок.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "traits.h"
+#include "bit_packing.h"
+
+template <typename Key, typename Item, typename Compare>                        // Общая часть FlatSet и FlatMap: Item – тип элемента
+class FlatContainer                                                             // (ключ или пара ключа и значения).
+{
+public:
+    using key_type = Key;
+    using value_type = Item;
+    using key_compare = Compare;
+    using size_type = size_t;
+    using iterator = typename std::vector<Item>::iterator;
+    using const_iterator = typename std::vector<Item>::const_iterator;
+
+    iterator begin()
+    {
+        return items.begin();
+    }
+
+    iterator end()
+    {
+        return items.end();
+    }
+
+    const_iterator begin() const
+    {
+        return items.begin();
+    }
+
+    const_iterator end() const
+    {
+        return items.end();
+    }
+
+    size_t size() const
+    {
+        return items.size();
+    }
+
+    bool empty() const
+    {
+        return items.empty();
+    }
+
+    void clear()
+    {
+        items.clear();
+    }
+
+    void reserve(size_t size)
+    {
+        items.reserve(size);
+    }
+
+    iterator lower_bound(const Key& key)                                        // Методы двоичного поиска.
+    {
+        return std::lower_bound(items.begin(), items.end(), key,
+                                KeyLess(compare));
+    }
+
+    const_iterator lower_bound(const Key& key) const
+    {
+        return std::lower_bound(items.begin(), items.end(), key,
+                                KeyLess(compare));
+    }
+
+    iterator find(const Key& key)
+    {
+        auto it = lower_bound(key);
+        return it != items.end() && !compare(key, key_of(*it)) ? it
+                                                               : items.end();
+    }
+
+    const_iterator find(const Key& key) const
+    {
+        auto it = lower_bound(key);
+        return it != items.end() && !compare(key, key_of(*it)) ? it
+                                                               : items.end();
+    }
+
+    size_t count(const Key& key) const
+    {
+        return find(key) != items.end() ? 1 : 0;
+    }
+
+    std::pair<iterator, bool> insert(Item item)                                 // Метод для вставки элемента (если элемента с таким ключом
+    {                                                                           // еще нет).
+        auto it = lower_bound(key_of(item));
+        if (it != items.end() && !compare(key_of(item), key_of(*it)))
+        {
+            return { it, false };
+        }
+        return { items.insert(it, std::move(item)), true };
+    }
+
+    template <typename... Args>                                                 // Метод для вставки элемента с подсказкой: вставка в конец
+    iterator emplace_hint(const_iterator hint, Args&&... args)                  // упорядоченных данных выполняется без поиска.
+    {
+        Item item(std::forward<Args>(args)...);
+        if (hint == items.end() &&
+            (items.empty() || compare(key_of(items.back()), key_of(item))))
+        {
+            items.push_back(std::move(item));
+            return items.end() - 1;
+        }
+        return insert(std::move(item)).first;
+    }
+
+    size_t erase(const Key& key)
+    {
+        auto it = find(key);
+        if (it == items.end())
+        {
+            return 0;
+        }
+        items.erase(it);
+        return 1;
+    }
+
+    iterator erase(const_iterator position)
+    {
+        return items.erase(position);
+    }
+
+    void load(std::vector<Item> loaded)                                         // Метод для загрузки элементов одним блоком (заменяет
+    {                                                                           // содержимое контейнера): упорядоченные элементы
+        items = std::move(loaded);                                              // проверяются за линейное время, иначе сортируются.
+        KeyLess less(compare);
+        if (std::adjacent_find(items.begin(), items.end(),
+                               [&](const Item& a, const Item& b)
+                               { return !less(a, key_of(b)); }) == items.end())
+        {
+            return;
+        }
+
+        std::stable_sort(items.begin(), items.end(),
+                         [&](const Item& a, const Item& b)
+                         { return less(a, key_of(b)); });
+        items.erase(std::unique(items.begin(), items.end(),
+                                [&](const Item& a, const Item& b)
+                                { return !less(a, key_of(b)); }),
+                    items.end());
+    }
+
+    const std::vector<Item>& data() const                                       // Метод для получения упорядоченного массива элементов.
+    {
+        return items;
+    }
+
+    bool operator==(const FlatContainer& other) const
+    {
+        return items == other.items;
+    }
+
+    bool operator!=(const FlatContainer& other) const
+    {
+        return items != other.items;
+    }
+
+protected:
+    static const Key& key_of(const Key& key)                                    // Функции для получения ключа элемента.
+    {
+        return key;
+    }
+
+    template <typename Value>
+    static const Key& key_of(const std::pair<Key, Value>& item)
+    {
+        return item.first;
+    }
+
+    struct KeyLess                                                              // Сравнение ключа элемента с ключом.
+    {
+        KeyLess(const Compare& compare) : compare(compare) {}
+
+        bool operator()(const Item& item, const Key& key) const
+        {
+            return compare(key_of(item), key);
+        }
+
+        const Compare& compare;
+    };
+
+    std::vector<Item> items;                                                    // Упорядоченные элементы.
+    Compare compare;                                                            // Сравнение ключей.
+};
+
+template <typename Key, typename Compare = std::less<Key>>
+class FlatSet : public FlatContainer<Key, Key, Compare>
+{
+public:
+    FlatSet() = default;
+
+    FlatSet(std::initializer_list<Key> keys)
+    {
+        this->load(std::vector<Key>(keys));
+    }
+};
+
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class FlatMap : public FlatContainer<Key, std::pair<Key, Value>, Compare>
+{
+public:
+    using mapped_type = Value;
+
+    FlatMap() = default;
+
+    FlatMap(std::initializer_list<std::pair<Key, Value>> items)
+    {
+        this->load(std::vector<std::pair<Key, Value>>(items));
+    }
+
+    Value& operator[](const Key& key)                                           // Оператор доступа к значению (создает значение по
+    {                                                                           // умолчанию, если ключа нет).
+        auto it = this->lower_bound(key);
+        if (it == this->items.end() || this->compare(key, it->first))
+        {
+            it = this->items.emplace(it, key, Value());
+        }
+        return it->second;
+    }
+
+    Value& at(const Key& key)
+    {
+        auto it = this->find(key);
+        if (it == this->items.end())
+        {
+            throw std::out_of_range("FlatMap key not found.");
+        }
+        return it->second;
+    }
+
+    const Value& at(const Key& key) const
+    {
+        auto it = this->find(key);
+        if (it == this->items.end())
+        {
+            throw std::out_of_range("FlatMap key not found.");
+        }
+        return it->second;
+    }
+};
+
+template <typename Key, typename Compare>
+struct is_flat_container<FlatSet<Key, Compare>> : std::true_type {};
+
+template <typename Key, typename Value, typename Compare>
+struct is_flat_container<FlatMap<Key, Value, Compare>> : std::true_type {};
+
+template <typename Key>                                                         // Ключи упаковываются так же, как у std::set и std::map
+struct has_packable_keys<FlatSet<Key>> : is_packable_key<Key> {};               // (только со стандартным компаратором).
+
+template <typename Key, typename Value>
+struct has_packable_keys<FlatMap<Key, Value>> : is_packable_key<Key> {};
\ No newline at end of file
@@ -0,0 +1,272 @@
+/*  Сжатие последовательностей чисел с плавающей точкой без потерь
+    (XOR с предыдущим значением, как в Gorilla): первое значение
+    записывается целиком, для остальных записывается XOR с предыдущим.
+    Для медленно меняющихся рядов XOR содержит много нулевых бит
+    в начале и в конце, поэтому записываются только значащие биты:
+    - '0' – значение совпадает с предыдущим;
+    - '10' и значащие биты – значащие биты помещаются в окно
+      предыдущего значения;
+    - '11', количество нулевых бит в начале (5 бит), количество
+      значащих бит минус 1 (6 бит) и значащие биты – новое окно.
+    Биты записываются от старших к младшим.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <algorithm>
+
+#include "traits.h"
+#include "bit_packing.h"
+
+template <typename T>                                                           // Проверка на последовательный контейнер чисел с плавающей
+struct is_float_sequence                                                        // точкой (float или double).
+    : std::integral_constant<bool,
+        (is_std_vector<T>::value || is_std_deque<T>::value ||
+         is_std_list<T>::value || is_std_forward_list<T>::value) &&
+        (std::is_same<typename T::value_type, float>::value ||
+         std::is_same<typename T::value_type, double>::value)> {};
+
+template <typename Float>                                                       // Целочисленный тип для битового представления числа.
+struct float_bits;
+
+template <>
+struct float_bits<float>
+{
+    using type = uint32_t;
+};
+
+template <>
+struct float_bits<double>
+{
+    using type = uint64_t;
+};
+
+class BitWriter                                                                 // Класс для записи последовательности бит в строку.
+{
+public:
+    void write(uint64_t value, unsigned count)                                  // Метод для записи count младших бит value (count <= 64).
+    {
+        while (count)
+        {
+            unsigned take = std::min(count, 8 - filled);
+            auto bits = static_cast<unsigned>(value >> (count - take)) &
+                        ((1u << take) - 1);
+            current |= bits << (8 - filled - take);
+            filled += take;
+            count -= take;
+
+            if (filled == 8)
+            {
+                data.push_back(static_cast<char>(current));
+                current = 0;
+                filled = 0;
+            }
+        }
+    }
+
+    std::string& finish()                                                       // Метод для завершения записи (дополняет последний байт
+    {                                                                           // нулями) и получения данных.
+        if (filled)
+        {
+            data.push_back(static_cast<char>(current));
+            current = 0;
+            filled = 0;
+        }
+        return data;
+    }
+
+private:
+    std::string data;                                                           // Записанные байты.
+    unsigned current = 0;                                                       // Текущий (незаполненный) байт.
+    unsigned filled = 0;                                                        // Количество записанных бит текущего байта.
+};
+
+class BitReader                                                                 // Класс для чтения последовательности бит из массива.
+{
+public:
+    BitReader(const char* data, size_t size)
+        : cursor(data), end(data + size) {}
+
+    bool read(unsigned count, uint64_t& value)                                  // Метод для чтения count бит в value (count <= 64).
+    {                                                                           // Возвращает false, если данные закончились.
+        value = 0;
+        while (count)
+        {
+            if (cursor == end)
+            {
+                return false;
+            }
+
+            unsigned left = 8 - used;
+            unsigned take = std::min(count, left);
+            auto byte = static_cast<uint8_t>(*cursor);
+            value = (value << take) |
+                    ((byte >> (left - take)) & ((1u << take) - 1));
+            used += take;
+            count -= take;
+
+            if (used == 8)
+            {
+                ++cursor;
+                used = 0;
+            }
+        }
+        return true;
+    }
+
+private:
+    const char* cursor;                                                         // Текущий байт.
+    const char* end;                                                            // Конец данных.
+    unsigned used = 0;                                                          // Количество прочитанных бит текущего байта.
+};
+
+template <typename Float>                                                       // Класс для сжатия последовательности чисел типа Float.
+class XorEncoder
+{
+public:
+    using Bits = typename float_bits<Float>::type;
+    static const unsigned width = sizeof(Bits) * 8;
+
+    void add(Float value)                                                       // Метод для добавления очередного значения.
+    {
+        Bits bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        if (first)
+        {
+            writer.write(bits, width);
+            previous = bits;
+            first = false;
+            return;
+        }
+
+        Bits x = bits ^ previous;
+        previous = bits;
+
+        if (!x)
+        {
+            writer.write(0, 1);
+            return;
+        }
+
+        unsigned leading = std::min(width - bit_width(x), 31u);
+        unsigned trailing = 0;
+        while (!((x >> trailing) & 1))
+        {
+            trailing++;
+        }
+
+        if (window && leading >= window_leading && trailing >= window_trailing) // Значащие биты помещаются в окно предыдущего значения.
+        {
+            writer.write(2, 2);
+            writer.write(x >> window_trailing,
+                         width - window_leading - window_trailing);
+            return;
+        }
+
+        unsigned length = width - leading - trailing;
+        writer.write(3, 2);
+        writer.write(leading, 5);
+        writer.write(length - 1, 6);
+        writer.write(x >> trailing, length);
+
+        window = true;
+        window_leading = leading;
+        window_trailing = trailing;
+    }
+
+    std::string& finish()                                                       // Метод для получения сжатых данных.
+    {
+        return writer.finish();
+    }
+
+private:
+    BitWriter writer;                                                           // Сжатые данные.
+    Bits previous = 0;                                                          // Предыдущее значение.
+    bool first = true;                                                          // Признак первого значения.
+    bool window = false;                                                        // Признак наличия окна значащих бит и его
+    unsigned window_leading = 0;                                                // границы (количество нулевых бит в начале
+    unsigned window_trailing = 0;                                               // и в конце).
+};
+
+template <typename Float>                                                       // Класс для распаковки последовательности чисел типа Float.
+class XorDecoder
+{
+public:
+    using Bits = typename float_bits<Float>::type;
+    static const unsigned width = sizeof(Bits) * 8;
+
+    XorDecoder(const char* data, size_t size) : reader(data, size) {}
+
+    bool next(Float& value)                                                     // Метод для чтения очередного значения. Возвращает false,
+    {                                                                           // если данные закончились или повреждены.
+        uint64_t bits = 0;
+
+        if (first)
+        {
+            if (!reader.read(width, bits))
+            {
+                return false;
+            }
+            first = false;
+        }
+        else
+        {
+            uint64_t control = 0;
+            if (!reader.read(1, control))
+            {
+                return false;
+            }
+
+            if (control)
+            {
+                if (!reader.read(1, control) || !read_window(control) ||
+                    !reader.read(width - window_leading - window_trailing, bits))
+                {
+                    return false;
+                }
+                bits = previous ^ (bits << window_trailing);
+            }
+            else
+            {
+                bits = previous;
+            }
+        }
+
+        previous = static_cast<Bits>(bits);
+        std::memcpy(&value, &previous, sizeof(previous));
+        return true;
+    }
+
+private:
+    bool read_window(uint64_t control)                                          // Метод для чтения нового окна значащих бит (если control
+    {                                                                           // равен 1) или проверки наличия предыдущего.
+        if (!control)
+        {
+            return window;
+        }
+
+        uint64_t leading = 0;
+        uint64_t length = 0;
+        if (!reader.read(5, leading) || !reader.read(6, length) ||
+            leading + length + 1 > width)
+        {
+            return false;
+        }
+
+        window = true;
+        window_leading = static_cast<unsigned>(leading);
+        window_trailing = static_cast<unsigned>(width - leading - length - 1);
+        return true;
+    }
+
+    BitReader reader;                                                           // Сжатые данные.
+    Bits previous = 0;                                                          // Предыдущее значение.
+    bool first = true;                                                          // Признак первого значения.
+    bool window = false;                                                        // Признак наличия окна значащих бит и его
+    unsigned window_leading = 0;                                                // границы.
+    unsigned window_trailing = 0;                                               //
+};
\ No newline at end of file
@@ -0,0 +1,199 @@
+/*  Класс GatherSink – приемник данных для архива, записывающий данные
+    в файловый дескриптор (файл, канал или сокет) без лишнего
+    копирования больших массивов:
+
+        GatherSink sink(fd);
+        Archive<GatherSink> oa(sink);
+        oa << message;
+        sink.flush();
+
+    Размеры и фундаментальные значения копируются в промежуточный буфер,
+    а элементы векторов и строк фундаментальных типов размером не меньше
+    порога передаются по ссылке. Накопленный список фрагментов
+    записывается вызовом writev. Поэтому сериализованные объекты нельзя
+    изменять или удалять до вызова flush() (или уничтожения приемника).
+    Формат данных не отличается от записи в std::ostream.
+    Ошибки записи приводят к исключениям std::runtime_error; записанные
+    до ошибки фрагменты отбрасываются, а повторный вызов flush()
+    продолжает запись с места ошибки (например, для неблокирующего
+    дескриптора после EAGAIN).
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "traits.h"
+
+class GatherSink
+{
+public:
+    GatherSink(int fd, size_t reference_threshold = 1024,                       // Конструктор с дескриптором (не закрывается приемником),
+               size_t staging_limit = 1 << 16)                                  // минимальным размером массива, передаваемого по ссылке,
+        : fd(fd), reference_threshold(reference_threshold),                     // и размером промежуточного буфера, при превышении
+          staging_limit(staging_limit) {}                                       // которого данные записываются автоматически.
+
+    GatherSink(const GatherSink&) = delete;
+    GatherSink& operator=(const GatherSink&) = delete;
+
+    ~GatherSink()
+    {
+        try
+        {
+            flush();
+        }
+        catch (...)                                                             // Деструктор не выбрасывает исключений: для обработки
+        {                                                                       // ошибок записи нужно вызывать flush() явно.
+        }
+    }
+
+    void write(const char* data, size_t size)                                   // Метод для записи данных с копированием (интерфейс потока).
+    {
+        if (segments.empty() || segments.back().data)                           // Соседние копии объединяются в один фрагмент.
+        {
+            segments.push_back({ nullptr, staging.size(), 0 });
+        }
+        staging.append(data, size);
+        segments.back().size += size;
+        copied += size;
+
+        if (staging.size() >= staging_limit)
+        {
+            flush();
+        }
+    }
+
+    void write_reference(const char* data, size_t size)                         // Метод для записи массива по ссылке (маленькие массивы
+    {                                                                           // копируются).
+        if (size < reference_threshold)
+        {
+            write(data, size);
+            return;
+        }
+        segments.push_back({ data, 0, size });
+        referenced += size;
+    }
+
+    void flush()                                                                // Метод для записи накопленных фрагментов.
+    {
+        std::vector<iovec> vectors;
+        vectors.reserve(segments.size());
+        for (const auto& segment : segments)
+        {
+            const char* data = segment.data ? segment.data
+                                            : staging.data() + segment.offset;
+            vectors.push_back({ const_cast<char*>(data), segment.size });
+        }
+
+        size_t next = 0;
+        while (next < vectors.size())                                           // Записываем не более max_vectors() фрагментов за вызов и
+        {                                                                       // продолжаем после частичной записи.
+            int count = static_cast<int>(
+                std::min(vectors.size() - next, max_vectors()));
+            ssize_t written = writev(fd, &vectors[next], count);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                std::string error = std::strerror(errno);
+                discard(next, segments[next].size - vectors[next].iov_len);
+                throw std::runtime_error("Gather write failed: " + error);
+            }
+
+            auto left = static_cast<size_t>(written);
+            while (next < vectors.size() && left >= vectors[next].iov_len)
+            {
+                left -= vectors[next].iov_len;
+                next++;
+            }
+            if (left)
+            {
+                vectors[next].iov_base =
+                    static_cast<char*>(vectors[next].iov_base) + left;
+                vectors[next].iov_len -= left;
+            }
+        }
+
+        segments.clear();
+        staging.clear();
+    }
+
+    size_t copied_bytes() const                                                 // Методы для получения количества скопированных
+    {                                                                           // и переданных по ссылке байт.
+        return copied;
+    }
+
+    size_t referenced_bytes() const
+    {
+        return referenced;
+    }
+
+    bool operator!() const                                                      // Оператор проверки состояния (как у потока).
+    {
+        return false;
+    }
+
+    static uint64_t input_size()                                                // Размер входных данных (для архива): неизвестен.
+    {
+        return std::numeric_limits<uint64_t>::max();
+    }
+
+private:
+    void discard(size_t count, size_t done)                                     // Метод для удаления count записанных фрагментов и done
+    {                                                                           // записанных байт следующего фрагмента.
+        segments.erase(segments.begin(), segments.begin() + count);
+        Segment& segment = segments.front();
+        segment.size -= done;
+        if (segment.data)
+        {
+            segment.data += done;
+        }
+        else
+        {
+            segment.offset += done;
+        }
+    }
+
+    static size_t max_vectors()                                                 // Максимальное количество фрагментов в одном вызове writev.
+    {
+#ifdef IOV_MAX
+        return IOV_MAX;
+#else
+        return 1024;
+#endif
+    }
+
+    struct Segment                                                              // Фрагмент данных.
+    {                                                                           // Поля:
+        const char* data;                                                       // - внешние данные (nullptr – промежуточный буфер);
+        size_t offset;                                                          // - смещение в промежуточном буфере;
+        size_t size;                                                            // - размер.
+    };
+
+    int fd;                                                                     // Дескриптор для записи.
+    size_t reference_threshold;                                                 // Минимальный размер массива, передаваемого по ссылке.
+    size_t staging_limit;                                                       // Размер промежуточного буфера для автоматической записи.
+    std::string staging;                                                        // Промежуточный буфер.
+    std::vector<Segment> segments;                                              // Накопленные фрагменты.
+    size_t copied = 0;                                                          // Количество скопированных байт.
+    size_t referenced = 0;                                                      // Количество байт, переданных по ссылке.
+};
+
+template <>
+struct is_ostream<GatherSink> : std::true_type {};
+
+template <>
+struct is_gather_ostream<GatherSink> : std::true_type {};
\ No newline at end of file
@@ -0,0 +1,248 @@
+/*  Хеширование сериализованного представления объектов без
+    промежуточного буфера (для ключей кэша и поиска одинаковых данных).
+    Класс HashingSink – приемник данных для архива, который не хранит
+    данные, а вычисляет их 64-битный хеш по мере записи:
+
+        HashingSink sink;
+        Archive<HashingSink> oa(sink);
+        oa << object;
+        uint64_t key = sink.hash();
+
+    Шаблон класса HashingTee<Sink> передает данные в другой приемник
+    (например, std::ostream) и одновременно вычисляет их хеш.
+    Кроме хеша всех данных, приемники вычисляют хеш секции – данных,
+    записанных после предыдущего вызова end_section(). Если записывать
+    в один архив несколько объектов и вызывать end_section() после
+    каждого, получаются хеши отдельных объектов: например, снимок
+    можно не записывать, если хеш его объекта не изменился.
+    Хеш не зависит от того, какими частями записываются данные, и
+    совпадает с stream_hash от сериализованного представления.
+    Хеш не является криптографическим.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "serialization.h"
+
+class StreamHash                                                                // Инкрементальное вычисление 64-битного хеша: данные
+{                                                                               // обрабатываются словами по 8 байт (перемешивание как в
+public:                                                                         // MurmurHash3).
+    void update(const char* data, size_t size)                                  // Метод для добавления данных.
+    {
+        length += size;
+        if (pending_size)                                                       // Дополняем неполное слово, оставшееся от прошлого вызова.
+        {
+            size_t count = std::min(size, sizeof(pending) - pending_size);
+            std::memcpy(pending + pending_size, data, count);
+            pending_size += count;
+            data += count;
+            size -= count;
+            if (pending_size < sizeof(pending))
+            {
+                return;
+            }
+            absorb(load(pending));
+            pending_size = 0;
+        }
+
+        for (; size >= sizeof(uint64_t); data += sizeof(uint64_t),
+                                          size -= sizeof(uint64_t))
+        {
+            absorb(load(data));
+        }
+
+        std::memcpy(pending, data, size);
+        pending_size = size;
+    }
+
+    uint64_t digest() const                                                     // Метод для получения хеша добавленных данных (данные
+    {                                                                           // можно добавлять и после вызова).
+        uint64_t hash = state;
+        if (pending_size)
+        {
+            char tail[sizeof(pending)] = {};
+            std::memcpy(tail, pending, pending_size);
+            hash ^= mix(load(tail));
+        }
+        hash ^= length;
+
+        hash ^= hash >> 33;                                                     // Финальное перемешивание.
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    void reset()                                                                // Метод для сброса состояния.
+    {
+        *this = StreamHash();
+    }
+
+private:
+    static uint64_t load(const char* data)
+    {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        return word;
+    }
+
+    static uint64_t rotate(uint64_t x, int bits)
+    {
+        return (x << bits) | (x >> (64 - bits));
+    }
+
+    static uint64_t mix(uint64_t word)
+    {
+        return rotate(word * 0x87c37b91114253d5ull, 31) *
+               0x4cf5ad432745937full;
+    }
+
+    void absorb(uint64_t word)
+    {
+        state ^= mix(word);
+        state = rotate(state, 27) * 5 + 0x52dce729;
+    }
+                                                                                // Поля:
+    uint64_t state = 0x9e3779b97f4a7c15ull;                                     // - состояние хеша;
+    uint64_t length = 0;                                                        // - количество добавленных байт;
+    char pending[sizeof(uint64_t)] = {};                                        // - неполное слово;
+    size_t pending_size = 0;                                                    // - размер неполного слова.
+};
+
+inline uint64_t stream_hash(const char* data, size_t size)                      // Функция для вычисления хеша массива байт.
+{
+    StreamHash hash;
+    hash.update(data, size);
+    return hash.digest();
+}
+
+class HashingSink
+{
+public:
+    void write(const char* data, size_t size)                                   // Метод для записи данных (интерфейс потока): данные
+    {                                                                           // только хешируются. Небольшие фрагменты накапливаются
+        if (size > sizeof(buffer) - buffered)                                   // в буфере и хешируются блоками.
+        {
+            flush();
+            if (size >= sizeof(buffer))
+            {
+                total.update(data, size);
+                section.update(data, size);
+                written += size;
+                return;
+            }
+        }
+        std::memcpy(buffer + buffered, data, size);
+        buffered += size;
+        written += size;
+    }
+
+    uint64_t hash() const                                                       // Метод для получения хеша всех записанных данных.
+    {
+        StreamHash hash = total;
+        hash.update(buffer, buffered);
+        return hash.digest();
+    }
+
+    uint64_t end_section()                                                      // Метод для получения хеша данных, записанных после
+    {                                                                           // предыдущего вызова, и начала новой секции.
+        flush();
+        uint64_t hash = section.digest();
+        section.reset();
+        return hash;
+    }
+
+    uint64_t size() const                                                       // Метод для получения количества записанных байт.
+    {
+        return written;
+    }
+
+    bool operator!() const                                                      // Оператор проверки состояния (как у потока).
+    {
+        return false;
+    }
+
+    static uint64_t input_size()                                                // Размер входных данных (для архива): неизвестен.
+    {
+        return std::numeric_limits<uint64_t>::max();
+    }
+
+private:
+    void flush()                                                                // Метод для хеширования накопленных данных.
+    {
+        total.update(buffer, buffered);
+        section.update(buffer, buffered);
+        buffered = 0;
+    }
+
+    StreamHash total;                                                           // Хеш всех данных.
+    StreamHash section;                                                         // Хеш текущей секции.
+    uint64_t written = 0;                                                       // Количество записанных байт.
+    char buffer[4096];                                                          // Накопленные данные.
+    size_t buffered = 0;                                                        // Размер накопленных данных.
+};
+
+template <typename Sink>
+class HashingTee
+{
+public:
+    HashingTee(Sink& sink) : sink(sink) {}                                      // Конструктор с приемником, в который передаются данные.
+
+    void write(const char* data, size_t size)                                   // Метод для записи данных (интерфейс потока).
+    {
+        sink.write(data, size);
+        hashing.write(data, size);
+    }
+
+    uint64_t hash() const
+    {
+        return hashing.hash();
+    }
+
+    uint64_t end_section()
+    {
+        return hashing.end_section();
+    }
+
+    uint64_t size() const
+    {
+        return hashing.size();
+    }
+
+    bool operator!() const
+    {
+        return !sink;
+    }
+
+    static uint64_t input_size()
+    {
+        return std::numeric_limits<uint64_t>::max();
+    }
+
+private:
+    Sink& sink;                                                                 // Приемник данных.
+    HashingSink hashing;                                                        // Хеширование данных.
+};
+
+template <>
+struct is_ostream<HashingSink> : std::true_type {};
+
+template <typename Sink>
+struct is_ostream<HashingTee<Sink>> : std::true_type {};
+
+template <typename T>                                                           // Функция для вычисления хеша сериализованного
+uint64_t content_hash(T& t)                                                     // представления объекта t.
+{
+    HashingSink sink;
+    {
+        Archive<HashingSink> archive(sink);
+        archive << t;
+    }
+    return sink.hash();
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+/*  Шаблон класса LazySequence – ленивое (поэлементное) чтение
+    последовательного контейнера из архива без создания самого
+    контейнера:
+
+        Archive<std::ifstream> ia(input);
+        for (auto& event : ia.lazy<std::vector<Event>>())
+        {
+            process(event);
+        }
+
+    Элементы десериализуются по одному при продвижении итератора,
+    поэтому в памяти находится только текущий элемент (бюджет памяти
+    архива тоже учитывает только его: память предыдущего элемента
+    возвращается в бюджет при чтении следующего). Итератор является
+    итератором ввода: последовательность можно пройти один раз, и
+    пока она не пройдена, архив нельзя использовать для чтения других
+    объектов. Ошибки десериализации выбрасываются из operator++ (или, в
+    режиме кодов ошибок, завершают последовательность).
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "serializer.h"
+
+template <typename Stream, typename Item>
+class LazySequence
+{
+public:
+    class iterator                                                              // Итератор ввода по элементам последовательности.
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Item;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Item*;
+        using reference = Item&;
+
+        iterator(LazySequence* sequence = nullptr) : sequence(sequence) {}      // Итератор без последовательности – конец.
+
+        Item& operator*() const
+        {
+            return sequence->item;
+        }
+
+        Item* operator->() const
+        {
+            return &sequence->item;
+        }
+
+        iterator& operator++()                                                  // Переход к следующему элементу (читает его из потока).
+        {
+            if (!sequence->next())
+            {
+                sequence = nullptr;
+            }
+            return *this;
+        }
+
+        void operator++(int)
+        {
+            ++*this;
+        }
+
+        bool operator==(const iterator& other) const
+        {
+            return sequence == other.sequence;
+        }
+
+        bool operator!=(const iterator& other) const
+        {
+            return sequence != other.sequence;
+        }
+
+    private:
+        LazySequence* sequence;                                                 // Последовательность (nullptr – конец).
+    };
+
+    iterator begin()                                                            // Метод для получения итератора на первый элемент
+    {                                                                           // (читает его из потока при первом вызове).
+        if (!started)
+        {
+            started = true;
+            available = next();
+        }
+        return iterator(available ? this : nullptr);
+    }
+
+    iterator end()
+    {
+        return iterator();
+    }
+
+    uint32_t size() const                                                       // Метод для получения количества элементов, записанных
+    {                                                                           // в архиве.
+        return count;
+    }
+
+private:
+    template <typename>
+    friend class Archive;
+
+    LazySequence(Serializer<Stream> serializer, uint32_t count)                 // Конструктор с сериализатором архива и количеством
+        : serializer(serializer), count(count), left(count),                    // элементов (создается методом Archive::lazy).
+          memory_used(serializer.limits ? serializer.limits->memory_used : 0) {}
+
+    bool next()                                                                 // Метод для чтения очередного элемента. Возвращает false,
+    {                                                                           // если элементы закончились или произошла ошибка.
+        if (!left || serializer.failed())
+        {
+            return false;
+        }
+
+        item = Item();                                                          // Элемент десериализуется "с нуля", как при чтении
+        if (serializer.limits)                                                  // контейнера; память предыдущего элемента освобождена.
+        {
+            serializer.limits->memory_used = memory_used;
+        }
+        serializer.serialize(item);
+        if (!serializer.check_input())
+        {
+            return false;
+        }
+        left--;
+        return true;
+    }
+
+    Serializer<Stream> serializer;                                              // Сериализатор архива.
+    uint32_t count;                                                             // Количество элементов в архиве.
+    uint32_t left;                                                              // Количество непрочитанных элементов.
+    Item item;                                                                  // Текущий элемент.
+    bool started = false;                                                       // Признак чтения первого элемента.
+    bool available = false;                                                     // Признак наличия текущего элемента.
+    uint64_t memory_used;                                                       // Память архива, учтенная до чтения элементов.
+};
\ No newline at end of file
@@ -0,0 +1,52 @@
+/*  Структура PointerTable – таблица разделяемых объектов архива. Если
+    таблица включена (Archive::set_shared_pointers), каждый непустой
+    указатель (Pointer) записывается с 4-байтной ссылкой: 0 – новый
+    объект, за которым следуют его данные (он получает очередной номер),
+    иначе – номер ранее записанного объекта с тем же адресом, типом
+    и размером. Данные, на которые ссылаются несколько указателей,
+    записываются и выделяются при чтении один раз; при чтении указатели
+    снова ссылаются на общий объект. Номер присваивается до записи
+    данных объекта, поэтому циклические ссылки не приводят к
+    бесконечной рекурсии.
+    Владельцем прочитанного объекта считается первый указатель
+    (AllocType::DynamicSingle или DynamicMultiple), остальные получают
+    AllocType::Shared: при повторном чтении они не освобождают память
+    и обнуляются (связи между указателями в новом архиве могут быть
+    другими).
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+template <typename T>                                                           // Функция для получения уникального адреса-метки типа
+const void* pointer_type_tag()                                                  // (не требует RTTI).
+{
+    static const char tag = 0;
+    return &tag;
+}
+
+struct PointerTable
+{
+    using Key = std::tuple<const void*, const void*, size_t>;                   // Ключ объекта: адрес, метка типа и размер.
+
+    struct Entry                                                                // Прочитанный объект.
+    {                                                                           // Поля:
+        void* ptr;                                                              // - адрес;
+        const void* type;                                                       // - метка типа;
+        size_t size;                                                            // - размер массива.
+    };
+
+    void clear()                                                                // Метод для очистки таблицы (например, перед записью или
+    {                                                                           // чтением независимого блока данных).
+        indices.clear();
+        entries.clear();
+    }
+                                                                                // Поля:
+    std::map<Key, uint32_t> indices;                                            // - номера записанных объектов (при сериализации);
+    std::vector<Entry> entries;                                                 // - прочитанные объекты (при десериализации).
+};
\ No newline at end of file
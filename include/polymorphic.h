@@ -0,0 +1,131 @@
+/*  Шаблон класса Polymorphic – владеющий указатель на объект
+    полиморфного класса для сериализации через базовый класс.
+    Наследники, которые могут храниться в указателе, перечисляются
+    для базового класса один раз:
+
+        template <>
+        struct polymorphic_types<Message>
+            : PolymorphicTypes<Message, TextMessage, ValueMessage> {};
+
+        std::vector<Polymorphic<Message>> messages;
+        messages.emplace_back(new TextMessage(...));
+
+    Номер типа – позиция наследника в списке (начиная с 1, 0 – пустой
+    указатель); он определяется один раз в конструкторе Polymorphic по
+    динамическому типу объекта (typeid), поэтому можно передавать
+    указатель на базовый класс. Если динамического типа нет в списке
+    (в том числе если это наследник зарегистрированного типа),
+    выбрасывается исключение std::invalid_argument. Номер не зависит от
+    сборки, если новые типы добавляются в конец списка. В поток
+    записывается номер типа (4 байта), затем объект. Сериализация и
+    десериализация выбираются по номеру из таблицы функций (без
+    dynamic_cast и имен типов). Базовый класс должен иметь виртуальный
+    деструктор.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+
+template <typename Base, typename... Derived>                                   // Список наследников базового класса Base.
+struct PolymorphicTypes
+{
+    static const uint32_t count = sizeof...(Derived);
+};
+
+template <typename Base>                                                        // Список наследников базового класса (специализируется
+struct polymorphic_types;                                                       // для каждого полиморфного базового класса).
+
+template <typename Base, typename... Types>                                     // Функция для получения номера динамического типа объекта
+uint32_t polymorphic_dynamic_id(const Base& object,                             // в списке наследников (0 – типа в списке нет).
+                                PolymorphicTypes<Base, Types...>)
+{
+    const std::type_info* types[] = { nullptr, &typeid(Types)... };
+    for (uint32_t i = 1; i <= sizeof...(Types); i++)
+    {
+        if (*types[i] == typeid(object))
+        {
+            return i;
+        }
+    }
+    return 0;
+}
+
+template <typename Base>
+class Polymorphic
+{
+public:
+    Polymorphic() = default;
+
+    template <typename Derived>                                                 // Конструктор с указателем на объект наследника или базового
+    explicit Polymorphic(Derived* ptr)                                          // класса (память должна быть выделена оператором new,
+        : ptr(ptr), id(dynamic_id(ptr)) {}                                      // указатель становится владельцем объекта, в том числе
+                                                                                // при исключении).
+    template <typename Derived>                                                 // Методы для замены объекта и для очистки указателя.
+    void reset(Derived* ptr)
+    {
+        std::unique_ptr<Base> owner(ptr);
+        id = dynamic_id(ptr);
+        this->ptr = std::move(owner);
+    }
+
+    void reset()
+    {
+        ptr.reset();
+        id = 0;
+    }
+
+    Base* get() const
+    {
+        return ptr.get();
+    }
+
+    Base& operator*() const
+    {
+        return *ptr;
+    }
+
+    Base* operator->() const
+    {
+        return ptr.get();
+    }
+
+    explicit operator bool() const
+    {
+        return ptr != nullptr;
+    }
+
+    uint32_t type_id() const                                                    // Метод для получения номера типа объекта (0 – пустой
+    {                                                                           // указатель).
+        return ptr ? id : 0;
+    }
+
+private:
+    template <typename Derived>                                                 // Функция для получения номера динамического типа объекта
+    static uint32_t dynamic_id(const Derived* ptr)                              // (исключение, если типа нет в списке наследников).
+    {
+        static_assert(std::is_base_of<Base, Derived>::value,
+                      "Type is not derived from the polymorphic base.");
+        static_assert(std::is_polymorphic<Base>::value,
+                      "Polymorphic base must have virtual functions.");
+        if (!ptr)
+        {
+            return 0;
+        }
+        uint32_t id = polymorphic_dynamic_id<Base>(*ptr,
+                                                   polymorphic_types<Base>());
+        if (id == 0)
+        {
+            throw std::invalid_argument(
+                "Type is not registered in polymorphic_types.");
+        }
+        return id;
+    }
+
+    std::unique_ptr<Base> ptr;                                                  // Объект.
+    uint32_t id = 0;                                                            // Номер типа объекта.
+};
\ No newline at end of file
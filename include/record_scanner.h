@@ -0,0 +1,296 @@
+/*  Файлы записей и их параллельная обработка.
+    Класс RecordWriter записывает объекты в поток записями с префиксом
+    длины: [размер записи (4 байта)][объект, сериализованный отдельным
+    архивом]. Границы записей известны без десериализации, поэтому
+    класс ParallelScanner может десериализовать записи в нескольких
+    потоках выполнения:
+
+        ParallelScanner scanner;
+        scanner.scan<Event>(data, [](size_t index, Event& event) { ... });
+
+    Сканер находит границы записей, делит их на диапазоны примерно
+    одинакового размера в байтах (записи могут сильно отличаться по
+    размеру) и раздает диапазоны потокам. Поток обрабатывает свои
+    диапазоны с начала очереди, а закончив их, забирает ("крадет")
+    диапазоны с конца очередей других потоков.
+    Функция обратного вызова вызывается из разных потоков одновременно
+    (index – номер записи в файле); порядок вызовов не определен.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "serialization.h"
+#include "worker_threads.h"
+
+class RecordWriter
+{
+public:
+    RecordWriter(std::ostream& stream) : stream(stream) {}                      // Конструктор с потоком для записи.
+
+    template <typename T>                                                       // Метод для записи объекта t отдельной записью.
+    void write(T& t)
+    {
+        std::ostringstream output(std::ios_base::binary);
+        {
+            Archive<std::ostringstream> archive(output);
+            archive << t;
+        }
+
+        const std::string record = output.str();
+        if (record.size() > std::numeric_limits<uint32_t>::max())               // Размер записи – 4 байта.
+        {
+            throw std::invalid_argument("Record size exceeds 2^32 bytes. "
+                                        "Serialization failed.");
+        }
+        auto size = static_cast<uint32_t>(record.size());
+        stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        stream.write(record.data(), record.size());
+    }
+
+private:
+    std::ostream& stream;                                                       // Поток для записи.
+};
+
+struct RecordInputBuffer                                                        // Буфер записи для чтения (используется вместо входного
+{                                                                               // потока). Данные не копируются.
+    RecordInputBuffer(const char* data, size_t size)
+        : cursor(data), end(data + size) {}
+
+    void read(char* data, size_t size)
+    {
+        if (size > size_t(end - cursor))
+        {
+            failed = true;
+            cursor = end;
+            return;
+        }
+        std::memcpy(data, cursor, size);
+        cursor += size;
+    }
+
+    bool operator!() const
+    {
+        return failed;
+    }
+
+    uint64_t input_size() const                                                 // Размер непрочитанных данных (для архива).
+    {
+        return uint64_t(end - cursor);
+    }
+
+    const char* cursor;                                                         // Текущая позиция чтения.
+    const char* end;                                                            // Конец записи.
+    bool failed = false;                                                        // Признак чтения за пределами записи.
+};
+
+template <>
+struct is_istream<RecordInputBuffer> : std::true_type {};
+
+class ParallelScanner
+{
+public:
+    ParallelScanner(size_t threads = 0, size_t ranges_per_thread = 8)           // Конструктор с количеством потоков (0 – по количеству
+        : threads(threads ? threads : default_threads()),                       // ядер) и количеством диапазонов на поток (больше
+          ranges_per_thread(std::max<size_t>(ranges_per_thread, 1)) {}          // диапазонов – лучше балансировка).
+
+    template <typename T, typename Callback>                                    // Метод для десериализации записей из данных data с вызовом
+    size_t scan(const std::string& data, Callback callback)                     // callback(index, object) для каждой записи. Возвращает
+    {                                                                           // количество записей. Ошибка разбора файла или исключение
+        std::vector<Record> records = index(data);                              // функции обратного вызова прерывает обработку и
+        std::vector<Range> ranges = split(records);                             // выбрасывается из scan.
+
+        size_t count = std::min(threads, std::max<size_t>(ranges.size(), 1));
+        std::vector<WorkQueue> queues(count);
+        for (size_t i = 0; i < ranges.size(); i++)                              // Раздаем потокам соседние диапазоны.
+        {
+            queues[i * count / ranges.size()].ranges.push_back(ranges[i]);
+        }
+
+        std::atomic<bool> stop(false);
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        auto worker = [&](size_t self)
+        {
+            Range range;
+            while (!stop.load(std::memory_order_relaxed) &&
+                   take(queues, self, range))
+            {
+                try
+                {
+                    for (size_t i = range.begin; i < range.end; i++)
+                    {
+                        decode<T>(data, records[i], i, callback);
+                    }
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                    stop = true;
+                }
+            }
+        };
+
+        {
+            WorkerThreads workers(&stop);                                       // Запущенные потоки дожидаются и при ошибке запуска
+            for (size_t i = 1; i < queues.size(); i++)                          // следующего потока (необработанные диапазоны
+            {                                                                   // пропускаются).
+                workers.start(worker, i);
+            }
+            worker(0);                                                          // Текущий поток тоже обрабатывает записи.
+        }
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+        return records.size();
+    }
+
+private:
+    struct Record                                                               // Запись: смещение данных и размер.
+    {
+        size_t offset;
+        size_t size;
+    };
+
+    struct Range                                                                // Диапазон номеров записей [begin, end).
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    struct WorkQueue                                                            // Очередь диапазонов потока.
+    {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+
+    static size_t default_threads()                                             // Функция для определения количества потоков по умолчанию.
+    {
+        return std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+    }
+
+    static std::vector<Record> index(const std::string& data)                   // Функция для поиска границ записей.
+    {
+        std::vector<Record> records;
+        size_t offset = 0;
+        while (offset < data.size())
+        {
+            uint32_t size = 0;
+            if (data.size() - offset < sizeof(size))
+            {
+                throw std::invalid_argument("Truncated record header. "
+                                            "Deserialization failed.");
+            }
+            std::memcpy(&size, data.data() + offset, sizeof(size));
+            offset += sizeof(size);
+
+            if (size > data.size() - offset)
+            {
+                throw std::invalid_argument("Record exceeds remaining input. "
+                                            "Deserialization failed.");
+            }
+            records.push_back({ offset, size });
+            offset += size;
+        }
+        return records;
+    }
+
+    std::vector<Range> split(const std::vector<Record>& records) const          // Метод для деления записей на диапазоны примерно
+    {                                                                           // одинакового размера в байтах.
+        size_t total = 0;
+        for (const auto& record : records)
+        {
+            total += record.size + sizeof(uint32_t);
+        }
+        size_t target = std::max<size_t>(
+            total / (threads * ranges_per_thread), 1);
+
+        std::vector<Range> ranges;
+        size_t begin = 0;
+        size_t bytes = 0;
+        for (size_t i = 0; i < records.size(); i++)
+        {
+            bytes += records[i].size + sizeof(uint32_t);
+            if (bytes >= target || i + 1 == records.size())
+            {
+                ranges.push_back({ begin, i + 1 });
+                begin = i + 1;
+                bytes = 0;
+            }
+        }
+        return ranges;
+    }
+
+    static bool take(std::vector<WorkQueue>& queues, size_t self,               // Функция для получения диапазона: сначала из начала своей
+                     Range& range)                                              // очереди, затем из конца очередей других потоков.
+    {
+        for (size_t i = 0; i < queues.size(); i++)
+        {
+            WorkQueue& queue = queues[(self + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.ranges.empty())
+            {
+                continue;
+            }
+
+            if (!i)
+            {
+                range = queue.ranges.front();
+                queue.ranges.pop_front();
+            }
+            else
+            {
+                range = queue.ranges.back();
+                queue.ranges.pop_back();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    template <typename T, typename Callback>                                    // Функция для десериализации одной записи (архив
+    static void decode(const std::string& data, const Record& record,           // ограничен размером записи).
+                       size_t index, Callback& callback)
+    {
+        RecordInputBuffer input(data.data() + record.offset, record.size);
+        T object;
+        {
+            Archive<RecordInputBuffer> archive(input);
+            archive >> object;
+        }
+        if (!input)
+        {
+            throw std::invalid_argument("Read past the end of record. "
+                                        "Deserialization failed.");
+        }
+        if (input.cursor != input.end)
+        {
+            throw std::invalid_argument("Record is not fully consumed. "
+                                        "Deserialization failed.");
+        }
+        callback(index, object);
+    }
+
+    size_t threads;                                                             // Количество потоков.
+    size_t ranges_per_thread;                                                   // Количество диапазонов на поток.
+};
\ No newline at end of file
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "serializer.h"
+#include "lazy_sequence.h"
 #include "traits.h"
 
 template <typename Stream>
@@ -17,8 +18,20 @@ public:
                   is_istream<Stream>::value,                                    // инстанцирование может производиться только от стандартных
                   "Template argument must be a stream.");                       // потоков.
 
-    Archive(Stream& stream) : serializer(Serializer<Stream>(stream)) {}         // Конструктор с передачей потока для сериализации по ссылке
-                                                                                // и созданием сериализатора для этого потока.
+    Archive(Stream& stream) : serializer(Serializer<Stream>(stream))            // Конструктор с передачей потока для сериализации по ссылке
+    {                                                                           // и созданием сериализатора для этого потока.
+        serializer.limits = &limits;                                            // Подключаем к сериализатору ограничения десериализации
+        serializer.errors = &errors;                                            // и состояние ошибок, определяем размер входного потока.
+        serializer.options = &options;
+        limits.input_size = input_size(stream);
+#ifdef SERIALIZATION_STATISTICS
+        serializer.statistics = &collected_statistics;                          // Подключаем к сериализатору статистику архива.
+#endif
+    }
+
+    Archive(const Archive&) = delete;                                           // Архив не копируется: сериализатор хранит указатели
+    Archive& operator=(const Archive&) = delete;                                // на данные архива.
+
     template <typename T, bool Enable=true>                                     // Оператор вывода в поток (сериализации) для lvalue-ссылок:
     typename std::enable_if<is_ostream<Stream>::value && Enable>::type          // доступен, только если шаблонный параметр является выходным
     operator<<(T& t)                                                            // потоком.
@@ -46,6 +59,180 @@ public:
         serializer.serialize(t);
     }
 
+    template <typename T>                                                       // Метод для сериализации/десериализации в режиме кодов
+    Status try_serialize(T& t) noexcept                                         // ошибок: не выбрасывает исключений и возвращает код первой
+    {                                                                           // ошибки архива. Ошибка сохраняется (последующие вызовы
+        errors.throw_errors = false;                                            // ничего не делают) до вызова clear_status().
+
+        try
+        {
+            serializer.serialize(t);
+
+            if (is_istream<Stream>::value)                                      // Проверяем, что во входном потоке хватило данных.
+            {
+                serializer.check_input();
+            }
+        }
+        catch (...)                                                             // Исключения могут выбрасываться только вне сериализатора
+        {                                                                       // (нехватка памяти, методы serialize пользовательских классов).
+            if (errors.status == Status::Ok)
+            {
+                errors.status = Status::Exception;
+            }
+        }
+
+        errors.throw_errors = true;
+        return errors.status;
+    }
+
+    template <typename Container>                                               // Метод для ленивого чтения последовательного контейнера
+    enable_if_t<is_istream<Stream>::value &&                                    // (вектора, дека, списка): возвращает последовательность,
+                (is_std_vector<Container>::value ||                             // элементы которой читаются из потока по одному при
+                 is_std_deque<Container>::value  ||                             // итерации (см. lazy_sequence.h).
+                 is_std_list<Container>::value   ||
+                 is_std_forward_list<Container>::value) &&
+                !is_columnar_container<Container>::value &&
+                !is_bit_vector<Container>::value,
+                LazySequence<Stream, typename Container::value_type>>
+    lazy()
+    {
+        using Item = typename Container::value_type;
+        uint32_t size = 0;
+        serializer.serialize(size);
+        serializer.check_input();
+
+        if (is_float_sequence<Container>::value && options.compressed_floats)  // Сжатые числа с плавающей точкой не читаются по одному.
+        {
+            serializer.fail(Status::UnsupportedType, []
+            {
+                return std::string("Lazy reading of compressed floats is not "
+                                   "supported. Deserialization failed.");
+            });
+        }
+        if (is_nested_contiguous<Container>::value &&                           // Элементы в раскладке «смещения и блок данных» тоже.
+            serializer.template blob_layout_enabled<Item>())
+        {
+            serializer.fail(Status::UnsupportedType, []
+            {
+                return std::string("Lazy reading of blob layout is not "
+                                   "supported. Deserialization failed.");
+            });
+        }
+        return LazySequence<Stream, Item>(serializer, size);
+    }
+
+    Status status() const                                                       // Метод для получения кода первой ошибки архива.
+    {
+        return errors.status;
+    }
+
+    void clear_status()                                                         // Метод для сброса ошибки архива (поток при необходимости
+    {                                                                           // нужно восстановить отдельно).
+        errors.status = Status::Ok;
+    }
+
+    template <bool Enable=true>                                                 // Метод для задания бюджета памяти, выделяемой при
+    typename std::enable_if<is_istream<Stream>::value && Enable>::type          // десериализации (в байтах): при его превышении
+    set_memory_budget(uint64_t bytes)                                           // десериализация прерывается исключением до выделения памяти.
+    {
+        limits.memory_budget = bytes;
+    }
+
+    void set_packed_keys(bool enabled)                                          // Метод для включения упаковки целочисленных ключей
+    {                                                                           // упорядоченных ассоциативных контейнеров (разности соседних
+        options.packed_keys = enabled;                                          // ключей, упакованные блоками, см. bit_packing.h). Должен
+    }                                                                           // совпадать при сериализации и десериализации.
+
+    void set_compressed_floats(bool enabled)                                    // Метод для включения сжатия последовательностей float
+    {                                                                           // и double (XOR с предыдущим значением, см.
+        options.compressed_floats = enabled;                                    // float_compression.h). Должен совпадать при сериализации
+    }                                                                           // и десериализации.
+
+    void set_blob_layout(bool enabled)                                          // Метод для включения раскладки «смещения и блок данных»
+    {                                                                           // для векторов строк и векторов векторов (см.
+        options.blob_layout = enabled;                                          // blob_layout.h). Должен совпадать при сериализации и
+    }                                                                           // десериализации.
+
+    void set_string_dictionary(bool enabled)                                    // Метод для включения словаря строк архива (повторяющиеся
+    {                                                                           // строки записываются ссылками, см. string_dictionary.h).
+        serializer.dictionary = enabled ? &dictionary : nullptr;                // Должен совпадать при сериализации и десериализации.
+    }
+
+    void clear_string_dictionary()                                              // Метод для очистки словаря строк (например, в начале
+    {                                                                           // независимого блока данных).
+        dictionary.clear();
+    }
+
+    void set_shared_pointers(bool enabled)                                      // Метод для включения таблицы разделяемых объектов (данные,
+    {                                                                           // на которые ссылаются несколько указателей Pointer,
+        serializer.pointers = enabled ? &pointer_table : nullptr;               // записываются один раз, см. pointer_table.h). Должен
+    }                                                                           // совпадать при сериализации и десериализации.
+
+    void clear_shared_pointers()                                                // Метод для очистки таблицы разделяемых объектов.
+    {
+        pointer_table.clear();
+    }
+
+    template <bool Enable=true>                                                 // Метод для задания кэша кодирования полей Memoized (кэш
+    typename std::enable_if<is_ostream<Stream>::value && Enable>::type          // может быть общим для нескольких архивов, nullptr –
+    set_encoding_cache(EncodingCache* cache)                                    // выключен, см. encoding_cache.h). Не влияет на формат.
+    {
+        serializer.cache = cache;
+    }
+
+    uint64_t memory_used() const                                                // Метод для получения объема памяти, выделенной при
+    {                                                                           // десериализации (учитывается в бюджете).
+        return limits.memory_used;
+    }
+
+#ifdef SERIALIZATION_STATISTICS
+    const Statistics& statistics() const                                        // Метод для получения статистики сериализации, собранной
+    {                                                                           // архивом (доступен, только если определен макрос
+        return collected_statistics;                                            // SERIALIZATION_STATISTICS).
+    }
+
+    void reset_statistics()                                                     // Метод для сброса собранной статистики.
+    {
+        collected_statistics.reset();
+    }
+#endif
+
 private:
+    static uint64_t input_size(std::istream& stream)                            // Функция для определения количества данных от текущей позиции
+    {                                                                           // до конца входного потока (если поток поддерживает
+        auto position = stream.tellg();                                         // позиционирование; иначе размер неизвестен).
+        if (position == std::istream::pos_type(-1) ||
+            !stream.seekg(0, std::ios_base::end))
+        {
+            stream.clear();
+            return DecodingLimits::unknown;
+        }
+
+        auto end = stream.tellg();
+        stream.seekg(position);
+        return static_cast<uint64_t>(end - position);
+    }
+
+    static uint64_t input_size(std::ostream&)                                   // Для выходного потока размер входных данных не нужен.
+    {
+        return DecodingLimits::unknown;
+    }
+
+    template <typename Buffer>                                                  // Для остальных приемников и источников данных (например,
+    static typename std::enable_if<                                             // FileSink и FileSource) размер сообщает сам объект.
+        !std::is_base_of<std::ios_base, Buffer>::value, uint64_t>::type
+    input_size(Buffer& buffer)
+    {
+        return buffer.input_size();
+    }
+
     Serializer<Stream> serializer;                                              // сериализатор, выполняющий, непосредственно, сериализацию.
+    DecodingLimits limits;                                                      // ограничения десериализации;
+    ErrorState errors;                                                          // состояние ошибок;
+    EncodingOptions options;                                                    // параметры кодирования;
+    StringDictionary dictionary;                                                // словарь строк;
+    PointerTable pointer_table;                                                 // таблица разделяемых объектов;
+#ifdef SERIALIZATION_STATISTICS
+    Statistics collected_statistics;                                            // статистика сериализации.
+#endif
 };
\ No newline at end of file
@@ -9,37 +9,166 @@
 
 #include <stdexcept>
 #include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <limits>
 
 #include "traits.h"
 #include "access.h"
+#include "decoding_limits.h"
+#include "status.h"
+#include "fixed_layout.h"
+#include "columnar.h"
+#include "bit_packing.h"
+#include "float_compression.h"
+#include "encoding_options.h"
+#include "string_dictionary.h"
+#include "pointer_table.h"
+#include "polymorphic.h"
+#include "encoding_cache.h"
+#include "flat_containers.h"
+#include "blob_layout.h"
+#include "unsized_range.h"
+
+#ifdef SERIALIZATION_STATISTICS                                                 // Макросы для сбора статистики сериализации (см. statistics.h):
+#include "statistics.h"                                                         // при выключенном сборе статистики раскрываются в пустоту.
+#define SERIALIZATION_STATISTICS_SCOPE(...)                                   \
+    StatisticsScope<__VA_ARGS__> statistics_scope(statistics)
+#define SERIALIZATION_STATISTICS_SIZE(T, size)                                \
+    if (statistics) statistics->record_size<T>(size)
+#define SERIALIZATION_STATISTICS_BYTES(size)                                  \
+    if (statistics) statistics->bytes += size
+#else
+#define SERIALIZATION_STATISTICS_SCOPE(...)
+#define SERIALIZATION_STATISTICS_SIZE(T, size)
+#define SERIALIZATION_STATISTICS_BYTES(size)
+#endif
 
 template <typename Stream>                                                      // Объявляем класс Archive для дальнейшего объявления его
 class Archive;                                                                  // дружественным к классу Serializer.
 
+template <typename Stream, typename Item>                                       // Ленивая последовательность элементов (см. lazy_sequence.h).
+class LazySequence;
+
 template <typename Stream>
 class Serializer
 {
 public:
-    template <typename T>                                                       // Единственный публичный метод – оператор ввода/вывода
-    void operator&(T& t)                                                        // для определения процедуры сериализации в методе serialize
-    {                                                                           // сериализуемого класса.
-        serialize(t);
+    template <typename T>                                                       // Оператор ввода/вывода для определения процедуры
+    void operator&(T& t)                                                        // сериализации в методе serialize сериализуемого класса.
+    {
+        serialize_member(t, is_columns<Stream>());
     }
 
+    template <typename... T>                                                    // Оператор для сериализации нескольких полей подряд:
+    void operator()(T&... t)                                                    // s(a, b, c) равносильно s & a; s & b; s & c;, но подряд
+    {                                                                           // идущие фундаментальные поля копируются через буфер на
+        serialize_members(is_columns<Stream>(), t...);                          // стеке и записываются (читаются) одной операцией. Формат
+    }                                                                           // данных не меняется.
+
 private:
     friend class Archive<Stream>;                                               // Дружественный класс Archive<Stream> – 
                                                                                 // предоставляет интерфейс взаимодействия.
     friend struct Access;                                                       // Дружественная структура Access – для возможности вызова
                                                                                 // конструктора класса Serializer при проверке is_serializable.
+    template <typename>                                                         // Сериализаторы других потоков – для сериализации объектов
+    friend class Serializer;                                                    // фиксированного размера через буферы (см. fixed_layout.h).
+    template <typename, typename>                                               // Ленивая последовательность – для поэлементного чтения
+    friend class LazySequence;                                                  // контейнера.
+
+    static const size_t max_staged_size = 1024;                                 // Максимальный размер объекта фиксированного размера,
+                                                                                // который сериализуется через буфер на стеке.
+    static const size_t bit_block_words = 64;                                   // Размер блока упакованных бит (в 64-битных словах).
     Serializer(Stream& stream) : stream(stream) {}                              // Конструктор с передачей потока для сериализации по ссылке. 
 
     Stream& stream;                                                             // Ссылка на поток для записи/чтения.
+    DecodingLimits* limits = nullptr;                                           // Указатель на ограничения десериализации архива (общие
+    ErrorState* errors = nullptr;                                               // для всех копий сериализатора, передаваемых в методы
+    const EncodingOptions* options = nullptr;                                   // serialize), на состояние ошибок, на параметры кодирования,
+    StringDictionary* dictionary = nullptr;                                     // на словарь строк (nullptr – словарь выключен), на таблицу
+    PointerTable* pointers = nullptr;                                           // разделяемых объектов (nullptr – выключена), на кэш
+    EncodingCache* cache = nullptr;                                             // кодирования (nullptr – выключен) и на статистику архива.
+#ifdef SERIALIZATION_STATISTICS
+    Statistics* statistics = nullptr;
+#endif
+
+    void write_bytes(const char* data, size_t size)                             // Метод для записи массива байт в поток – через него
+    {                                                                           // проходят все операции записи.
+        stream.write(data, size);
+        SERIALIZATION_STATISTICS_BYTES(size);
+    }
+
+    void read_bytes(char* data, size_t size)                                    // Метод для чтения массива байт из потока – через него
+    {                                                                           // проходят все операции чтения.
+        stream.read(data, size);
+        SERIALIZATION_STATISTICS_BYTES(size);
+
+        if (limits)
+        {
+            limits->consumed += size;
+        }
+    }
+
+    template <typename Message>                                                 // Метод для обработки ошибки сериализации: выбрасывает
+    void fail(Status status, const Message& message)                            // исключение с сообщением message() или, в режиме кодов
+    {                                                                           // ошибок, сохраняет первую ошибку в состоянии архива
+        if (!errors || errors->throw_errors)                                    // (сообщение при этом не формируется).
+        {
+            throw std::invalid_argument(message());
+        }
+
+        if (errors->status == Status::Ok)
+        {
+            errors->status = status;
+        }
+    }
+
+    bool failed() const                                                         // Метод для проверки наличия ошибки (только в режиме кодов
+    {                                                                           // ошибок): проверяется один раз в начале сериализации
+        return errors && !errors->throw_errors &&                               // каждого контейнера или класса, а не для каждого
+               errors->status != Status::Ok;                                    // фундаментального значения.
+    }
+
+    template <typename T>                                                       // Метод для проверки заявленного в потоке количества
+    bool claim(uint64_t count,                                                  // элементов типа T перед выделением памяти под них
+               uint64_t min_size = min_encoded_size<T>::value)                  // (см. DecodingLimits::claim).
+    {
+        bool verified = false;
+        if (limits)
+        {
+            Status status = limits->claim<T>(count, verified, min_size);
+            if (status != Status::Ok)
+            {
+                fail(status, [&] { return limits->describe(status, count); });
+            }
+        }
+        return verified;
+    }
+
+    bool check_input()                                                          // Метод для проверки состояния входного потока: сообщает об
+    {                                                                           // ошибке, если данные в потоке закончились раньше, чем
+        if (!stream)                                                            // ожидалось (например, из-за неверного размера контейнера).
+        {                                                                       // Возвращает false, если сериализацию нужно прекратить.
+            fail(Status::UnexpectedEnd, []
+            {
+                return std::string(
+                    "Unexpected end of input. Deserialization failed.");
+            });
+        }
+        return !failed();
+    }
 
                                                                                 // Шаблонные перегрузки метода serialize:
     template <typename T>                                                       // (1) подставляется, если:
-    enable_if_t<is_serializable<T>::value>                                      // – у объекта t есть метод serialize.
+    enable_if_t<is_serializable<T>::value &&                                    // – у объекта t есть метод serialize; и
+                !is_fixed_layout<T>::value>                                     // – размер объекта не известен на этапе компиляции.
     serialize(T& t)                                                             // Возвращает void (тип по умолчанию для enable_if).
     {
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
         Access::serialize(*this, t);                                            // Вызываем метод serialize у объекта через структуру Access
     }                                                                           // (на случай, если метод serialize приватный)
 
@@ -47,11 +176,31 @@ private:
     template <typename T>                                                       // (2) подставляется, если:
     enable_if_t<is_iterable<T>::value &&                                        // – тип T поддерживает range-based for loop; и
                 has_size<T>::value   &&                                         // – имеет метод size() (все контейнеры, кроме forward_list); и
+                !is_fixed_layout<T>::value &&                                   // – размер объекта не известен на этапе компиляции; и
+                !is_columnar_container<T>::value &&                             // – контейнер не сериализуется по колонкам и не является
+                !is_flat_container<T>::value &&                                 // FlatSet, FlatMap или вектором bool; и
+                !is_bit_vector<T>::value &&
                 is_ostream<Stream>::value>                                      // – поток, которым инстанцирован шаблон класса – выходной.
     serialize(T& t)                                                             // Возвращает void.
     {
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        if (write_string_reference(t, std::is_same<T, std::string>()))          // Записываем ссылку на строку из словаря архива (если она
+        {                                                                       // уже встречалась),
+            return;
+        }
         auto size = static_cast<uint32_t>(t.size());                            // Считываем размер контейнера и приводим к размеру 4 байта,
+        SERIALIZATION_STATISTICS_SIZE(T, size);
         serialize(size);                                                        // сериализуем размер,
+        if (write_packed_keys(t, has_packable_keys<T>()) ||                     // упаковываем ключи, сжимаем числа с плавающей точкой или
+            write_compressed_floats(t, is_float_sequence<T>()) ||               // записываем смещения и блок данных, если это включено,
+            write_blob_layout(t, is_nested_contiguous<T>()))
+        {
+            return;
+        }
         serialize_container(t);                                                 // сериализуем элементы контейнера.
     }
 
@@ -61,28 +210,53 @@ private:
                 is_ostream<Stream>::value>                                      // (т.к. у std::forward_list нет метода size()); и
     serialize(T& t)                                                             // – поток, которым инстанцирован шаблон класса – выходной.
     {                                                                           // Возвращает void.
-        auto size = static_cast<uint32_t>(std::distance(t.begin(), t.end()));   // Вычисляем размер контейнера прохождением от начала до конца,
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        if (write_unsized(t, is_memory_ostream<Stream>()))                      // В поток в памяти записываем список за один проход
+        {                                                                       // с последующей записью размера.
+            return;
+        }
+        auto size = static_cast<uint32_t>(std::distance(t.begin(), t.end()));   // Иначе вычисляем размер контейнера прохождением от начала до конца,
+        SERIALIZATION_STATISTICS_SIZE(T, size);
         serialize(size);                                                        // сериализуем его,
+        if (write_compressed_floats(t, is_float_sequence<T>()))                 // сжимаем числа с плавающей точкой, если это включено,
+        {
+            return;
+        }
         serialize_container(t);                                                 // сериализуем элементы контейнера.
     }
 
 
     template <typename T>                                                       // (4) подставляется, если:
     enable_if_t<is_std_array<T>::value &&                                       // – тип T – стандартный статический массив;
+                !is_fixed_layout<T>::value &&                                   // – размер массива не известен на этапе компиляции;
                 is_istream<Stream>::value>                                      // и
     serialize(T& t)                                                             // – поток, которым инстанцирован шаблон класса – входной.
     {                                                                           // Возвращает void.
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
         uint32_t size = 0;                                                      // Создаем переменную для размера массива и
         serialize(size);                                                        // десериализуем в нее данные о размере.
+        SERIALIZATION_STATISTICS_SIZE(T, size);
         
         if (size != t.size())                                                   // Если размер ранее сериализованного и десериализуемого
         {                                                                       // отличаются (для статических массивов это недопустимо),
-            std::ostringstream os;                                              // формируем сообщение об ошибке
-            os << "Different sizes of static std arrays. "                      //
-               << "Serialized array size: " << size                             //
-               << ". Deserializing array size: " << t.size()                    //
-               << ". Deserialization failed.";                                  //
-            throw std::invalid_argument(os.str());                              // и выбрасываем исключение.
+            fail(Status::SizeMismatch, [&]                                      // сообщаем об ошибке.
+            {
+                std::ostringstream os;                                          // Формируем сообщение об ошибке
+                os << "Different sizes of static std arrays. "                  //
+                   << "Serialized array size: " << size                         //
+                   << ". Deserializing array size: " << t.size()                //
+                   << ". Deserialization failed.";                              //
+                return os.str();                                                // для исключения.
+            });
+            return;
         }
 
         for (auto& item : t)                                                    // Если размеры равны, итерируемся по массиву и десериализуем
@@ -94,17 +268,20 @@ private:
 
     template <typename T>                                                       // (5) подставляется, если:
     enable_if_t<(is_std_vector<T>::value  ||                                    // – тип T – стандартный последовательный контейнер, 
-                 is_std_string<T>::value) &&                                    // хранящий данные в куче (вектор или строка);
+                 is_std_string<T>::value) &&                                    // хранящий данные в куче (вектор, кроме вектора bool, или
+                 !is_bit_vector<T>::value &&                                    // строка);
+                 !is_columnar_container<T>::value &&                            // – контейнер не сериализуется по колонкам; и
                  is_istream<Stream>::value>                                     // и
     serialize(T& t)                                                             // – поток, которым инстанцирован шаблон класса – входной.
     {                                                                           // Возвращает void.
-        uint32_t size = 0;                                                      // Создаем переменную для размера контейнера и
-        serialize(size);                                                        // десериализуем в нее данные о размере.
-        t.resize(size);                                                         // Изменяем размер десериализуемого контейнера.
-
-        for (auto& item : t)                                                    // Итерируемся по контейнеру и десериализуем его поэлементно.
+        if (failed())
         {
-            serialize(item);
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        if (!read_string_reference(t, std::is_same<T, std::string>()))          // Строка может быть ссылкой на словарь архива.
+        {
+            read_sequence(t);
         }
     }
 
@@ -112,17 +289,37 @@ private:
     template <typename T>                                                       // (6) подставляется, если:
     enable_if_t<(is_std_list<T>::value   ||                                     // – тип T – стандартный двусвязный список (лист или дек);
                  is_std_deque<T>::value) &&                                     // и
+                 !is_columnar_container<T>::value &&                            // – контейнер не сериализуется по колонкам; и
                  is_istream<Stream>::value>                                     // – поток, которым инстанцирован шаблон класса – входной.
     serialize(T& t)                                                             // Возвращает void.
     {
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
         uint32_t size = 0;                                                      // Создаем переменную для размера списка и
         serialize(size);                                                        // десериализуем в нее данные о размере.
+        SERIALIZATION_STATISTICS_SIZE(T, size);
+        if (read_compressed_floats(t, size, is_float_sequence<T>()))            // Распаковываем числа с плавающей точкой, если сжатие
+        {                                                                       // включено.
+            return;
+        }
+        claim<typename T::value_type>(size);                                    // Проверяем заявленный размер.
+        if (failed())
+        {
+            return;
+        }
         t.clear();                                                              // Очищаем текущее содержимое списка.
 
         for (uint32_t i = 0; i < size; i++)                                     // Делаем size итераций:
         {
             typename T::value_type item;                                        // Создаем элемент типа, от которого инстанцирован список,
             serialize(item);                                                    // и десериализуем его.
+            if (!check_input())                                                 // Прекращаем десериализацию при ошибке.
+            {
+                return;
+            }
             t.push_back(std::move(item));                                       // Перемещаем десериализованный элемент в конец списка
         }                                                                       // (чтобы избежать копирования).
     }
@@ -133,14 +330,33 @@ private:
                 is_istream<Stream>::value>                                      // и
     serialize(T& t)                                                             // – поток, которым инстанцирован шаблон класса – входной.
     {                                                                           // Возвращает void.
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
         uint32_t size = 0;                                                      // Создаем переменную для размера списка и
         serialize(size);                                                        // десериализуем в нее данные о размере.
+        SERIALIZATION_STATISTICS_SIZE(T, size);
+        if (read_compressed_floats(t, size, is_float_sequence<T>()))            // Распаковываем числа с плавающей точкой, если сжатие
+        {                                                                       // включено.
+            return;
+        }
+        claim<typename T::value_type>(size);                                    // Проверяем заявленный размер.
+        if (failed())
+        {
+            return;
+        }
         t.clear();                                                              // Очищаем текущее содержимое списка.
 
         for (uint32_t i = 0; i < size; i++)                                     // Делаем size итераций:
         {
             typename T::value_type item;                                        // Создаем элемент типа, от которого инстанцирован список,
             serialize(item);                                                    // и десериализуем его.
+            if (!check_input())                                                 // Прекращаем десериализацию при ошибке.
+            {
+                return;
+            }
             t.push_front(std::move(item));                                      // Перемещаем десериализованный элемент в начало списка
         }                                                                       // (т.к. у std::forward_list нет метода push_back).
 
@@ -150,18 +366,38 @@ private:
 
     template <typename T>                                                       // (8) подставляется, если:
     enable_if_t<is_iterable<T>::value &&                                        // – тип T – ассоциативный контейнер (проверяем, поддерживается
-                has_insert<T>::value &&                                         // ли range-based for loop, и наличие метода insert());
+                has_insert<T>::value &&                                         // ли range-based for loop, и наличие метода insert()), кроме
+                !is_flat_container<T>::value &&                                 // FlatSet и FlatMap;
                 is_istream<Stream>::value>                                      // и
     serialize(T& t)                                                             // – поток, которым инстанцирован шаблон класса – входной.
     {
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
         uint32_t size = 0;                                                      // Создаем переменную для размера контейнера и
         serialize(size);                                                        // десериализуем в нее данные о размере.
+        SERIALIZATION_STATISTICS_SIZE(T, size);
+        if (read_packed_keys(t, size, has_packable_keys<T>()))                  // Распаковываем ключи, если упаковка включена.
+        {
+            return;
+        }
+        claim<typename T::value_type>(size);                                    // Проверяем заявленный размер.
+        if (failed())
+        {
+            return;
+        }
         t.clear();                                                              // Очищаем текущее содержимое контейнера.
 
         for (uint32_t i = 0; i < size; i++)                                     // Делаем size итераций:
         {
             typename T::value_type item;                                        // Создаем элемент типа, от которого инстанцирован контейнер,
             serialize(item);                                                    // и десериализуем его.
+            if (!check_input())                                                 // Прекращаем десериализацию при ошибке.
+            {
+                return;
+            }
             t.insert(std::move(item));                                          // Перемещаем десериализованный элемент в контейнер
         }
     }
@@ -170,6 +406,11 @@ private:
     template <typename First, typename Second>                                  // (9) подставляется для стандартных пар:
     void serialize(std::pair<const First, Second>& t)                           // первый тип константный, т.к. элементы std::map имеют тип
     {                                                                           // std::pair<const Key, Value> – иначе не подставляется.
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(std::pair<const First, Second>);
         serialize(*const_cast<First*>(&t.first));                               // Разыменовываем и сериализуем неконстантный указатель на
         serialize(t.second);                                                    // первое поле и просто сериализуем второе.
     }
@@ -179,12 +420,22 @@ private:
     enable_if_t<is_ostream<Stream>::value && Enable>                            // поток, которым инстанцирован шаблон класса - выходной.
     serialize(Pointer<T>& t)                                                    // Сериализует содержимое указателя. Возвращает void.
     {
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(Pointer<T>);
         bool ptr_is_null = t.ptr ? false : true;                                // Создаем и инициализируем переменную-индикатор пустого указателя.
         serialize(ptr_is_null);                                                 // Сериализуем эту переменную.
 
         if (!ptr_is_null)                                                       // Если указатель ненулевой:
         {
+            if (write_pointer_reference(t))                                     // Записываем ссылку на разделяемый объект (если он уже
+            {                                                                   // записан),
+                return;
+            }
             serialize(t.size);                                                  // Сериализуем размер массива данных указателя.
+            SERIALIZATION_STATISTICS_SIZE(Pointer<T>, t.size);
             for (size_t i = 0; i < t.size; i++)                                 // Поэлементно сериализуем массив данных.
             {
                 serialize(t.ptr[i]);                                            //
@@ -196,19 +447,31 @@ private:
     enable_if_t<is_istream<Stream>::value && Enable>                            // поток, которым инстанцирован шаблон класса - входной.
     serialize(Pointer<T>& t)                                                    // Десериализует содержимое указателя. Возвращает void.
     {
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(Pointer<T>);
         switch (t.alloc_type)                                                   // В зависимости от того, как была выделена память для
         {                                                                       // текущего указателя:
         case AllocType::DynamicSingle:                                          // Если для одного элемента в куче (оператор new),
             delete t.ptr;                                                       // освобождаем память с помощью delete.
+            t.ptr = nullptr;                                                    // Обнуляем указатель, чтобы память была выделена заново.
             break;
         
         case AllocType::DynamicMultiple:                                        // Если для нескольких элементов в куче (оператор new[]),
             delete[] t.ptr;                                                     // освобождаем память с помощью delete[].
+            t.ptr = nullptr;                                                    //
             break;
 
+        case AllocType::Shared:                                                 // Если указатель ссылается на объект другого указателя,
+            t.ptr = nullptr;                                                    // не освобождаем память и не читаем в нее данные (объект
+            break;                                                              // мог быть освобожден или станет новым объектом).
+
         default:                                                                // Если указатель нулевой или указывает на данные не в куче,
             break;                                                              // освобождать память не нужно.
         }
+        size_t capacity = t.ptr ? t.size : 0;                                   // Размер памяти, в которую данные читаются на месте.
 
         bool ptr_is_null;                                                       // Создаем переменную-индикатор нулевого сериализованного указателя,
         serialize(ptr_is_null);                                                 // десериализуем ее.
@@ -217,8 +480,35 @@ private:
         {
             t.size = 0;                                                         // размер массива данных указателя - нулевой.
         }
-                                                                                // Если был сериализован ненулевой указатель,
-        serialize(t.size);                                                      // сериализуем размер данных массива данных
+        else                                                                    // Если был сериализован ненулевой указатель,
+        {
+            if (read_pointer_reference(t))                                      // читаем ссылку на разделяемый объект (если таблица
+            {                                                                   // включена и объект уже прочитан – данных нет),
+                return;
+            }
+            serialize(t.size);                                                  // сериализуем размер данных массива данных
+            if (check_input())                                                  // и проверяем его перед выделением памяти.
+            {
+                claim<typename std::remove_pointer<T>::type>(t.size);
+            }
+            if (!failed() && t.ptr && t.size > capacity)                        // Данные не в куче (например, разделяемый объект, на
+            {                                                                   // который ссылается указатель) читаются на месте и не
+                fail(Status::InvalidData, [&]                                   // должны выходить за границы имеющейся памяти.
+                {
+                    std::ostringstream os;
+                    os << "Pointer data size " << t.size
+                       << " exceeds the existing allocation of " << capacity
+                       << " elements. Deserialization failed.";
+                    return os.str();
+                });
+            }
+
+            if (failed())                                                       // При ошибке считаем указатель пустым.
+            {
+                t.size = 0;
+            }
+        }
+        SERIALIZATION_STATISTICS_SIZE(Pointer<T>, t.size);
 
         if (!t.size)                                                            // Если размер массива данных нулевой:
         {
@@ -241,6 +531,7 @@ private:
             }
         }
 
+        remember_pointer(t);                                                    // Запоминаем объект до чтения данных (для циклических ссылок).
         for (size_t i = 0; i < t.size; i++)                                     // Поэлементно десериализуем массив данных.
         {
             serialize(t.ptr[i]);                                                //
@@ -250,12 +541,14 @@ private:
 
     template <typename T>                                                       // (12) подставляется, если:
     enable_if_t<std::is_pointer<T>::value>                                      // – тип T – указатель.
-    serialize(T& t)                                                             // Выбрасывает исключение независимо от направления сериализации.
+    serialize(T&)                                                               // Сообщает об ошибке независимо от направления сериализации.
     {
-        std::ostringstream os;                                                  // Формируем сообщение об ошибке
-        os << "Direct pointer serialization not supported. "                    //
-           << "Use 'Pointer' struct instead. Serialization failed.";            //
-        throw std::invalid_argument(os.str());                                  // и выбрасываем исключение.
+        fail(Status::UnsupportedType, []                                        // Сообщаем об ошибке.
+        {
+            return std::string("Direct pointer serialization not supported. "
+                               "Use 'Pointer' struct instead. "
+                               "Serialization failed.");
+        });
     }
 
 
@@ -264,7 +557,8 @@ private:
                 is_ostream<Stream>::value>                                      // и
     serialize(T& t)                                                             // – поток, которым инстанцирован шаблон класса – выходной.
     {                                                                           // Возвращает void.
-        stream.write(reinterpret_cast<const char*>(&t), sizeof(t));             // Приводим указатель на t к указателю на const char (сигнатура
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        write_bytes(reinterpret_cast<const char*>(&t), sizeof(t));              // Приводим указатель на t к указателю на const char (сигнатура
     }                                                                           // метода ostream::write) и записываем массив байт размером
                                                                                 // sizeof(t) в поток
 
@@ -273,23 +567,1487 @@ private:
                 is_istream<Stream>::value>                                      // и
     serialize(T& t)                                                             // – поток, которым инстанцирован шаблон класса – входной.
     {                                                                           // Возвращает void.
-        stream.read(const_cast<char*>(reinterpret_cast<const char*>(&t)),       // Приводим указатель на t к неконстантному указателю на char и
-                    sizeof(t));                                                 // записываем массив байт размера sizeof(t) по этому указателю
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        read_bytes(const_cast<char*>(reinterpret_cast<const char*>(&t)),        // Приводим указатель на t к неконстантному указателю на char и
+                   sizeof(t));                                                  // записываем массив байт размера sizeof(t) по этому указателю
     }
 
 
     void serialize(...)                                                         // (15) подставляется, если ни одна из вышеперечисленных
     {                                                                           // перегрузок не является допустимой.
-        throw std::invalid_argument("Unsupported type. Serialization failed."); // Выбрасываем исключение с сообщением о том, что сериализация
-    }                                                                           // для требуемого типа не поддерживается.
+        fail(Status::UnsupportedType, []                                        // Сообщаем об ошибке (выбрасываем исключение с сообщением о
+        {                                                                       // том, что сериализация для требуемого типа не поддерживается).
+            return std::string("Unsupported type. Serialization failed.");
+        });
+    }
 
 
-    template <typename T>                                                       // Метод для сериализации (только запись в поток) контейнера,
-    void serialize_container(T& t)                                              // поддерживающего range-based for loop.
+    template <typename T>                                                       // (16) подставляется, если:
+    enable_if_t<is_fixed_layout<T>::value &&                                    // – размер объекта известен на этапе компиляции (статический
+                is_ostream<Stream>::value>                                      // массив или класс с объявленным fixed_layout); и
+    serialize(T& t)                                                             // – поток, которым инстанцирован шаблон класса – выходной.
+    {                                                                           // Префикс длины не записывается. Возвращает void.
+        if (failed())
+        {
+            return;
+        }
+
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        write_fixed(t, is_staged<T>());
+    }
+
+
+    template <typename T>                                                       // (17) подставляется, если:
+    enable_if_t<is_fixed_layout<T>::value &&                                    // – размер объекта известен на этапе компиляции; и
+                is_istream<Stream>::value>                                      // – поток, которым инстанцирован шаблон класса – входной.
+    serialize(T& t)                                                             // Размеры не сравниваются: они совпадают по построению.
+    {                                                                           // Возвращает void.
+        if (failed())
+        {
+            return;
+        }
+
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        read_fixed(t, is_staged<T>());
+    }
+
+
+    template <typename T>                                                       // (18) подставляется, если:
+    enable_if_t<is_columnar_container<T>::value &&                              // – контейнер объектов класса с включенной поколоночной
+                is_ostream<Stream>::value>                                      // сериализацией (см. columnar.h); и
+    serialize(T& t)                                                             // – поток, которым инстанцирован шаблон класса – выходной.
+    {                                                                           // Возвращает void.
+        if (failed())
+        {
+            return;
+        }
+
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        auto size = static_cast<uint32_t>(t.size());                            // Сериализуем количество строк (размер контейнера).
+        SERIALIZATION_STATISTICS_SIZE(T, size);
+        serialize(size);
+
+        ColumnOutput output;                                                    // Раскладываем поля объектов по колонкам.
+        Serializer<ColumnOutput> s(output);
+        s.errors = errors;
+        s.options = options;
+        s.dictionary = dictionary;
+        s.pointers = pointers;
+        s.cache = cache;
+
+        for (auto& item : t)
+        {
+            output.field = 0;
+            Access::serialize(s, item);
+        }
+
+        std::vector<std::string> columns;                                       // Сериализуем колонки как вектор строк.
+        for (auto& column : output.columns)
+        {
+            columns.push_back(std::move(column.data));
+        }
+        serialize_columns(columns);
+    }
+
+
+    template <typename T>                                                       // (19) подставляется, если:
+    enable_if_t<is_columnar_container<T>::value &&                              // – контейнер объектов класса с включенной поколоночной
+                is_istream<Stream>::value>                                      // сериализацией; и
+    serialize(T& t)                                                             // – поток, которым инстанцирован шаблон класса – входной.
+    {                                                                           // Возвращает void.
+        if (failed())
+        {
+            return;
+        }
+
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        uint32_t size = 0;                                                      // Десериализуем количество строк и проверяем его.
+        serialize(size);
+        SERIALIZATION_STATISTICS_SIZE(T, size);
+
+        using Item = typename T::value_type;
+        claim<Item>(size);
+
+        std::vector<std::string> columns;                                       // Десериализуем колонки (с проверкой их длин).
+        serialize_columns(columns);
+        if (!check_input())
+        {
+            return;
+        }
+
+        DecodingLimits column_limits;                                           // Ограничения для колонок: общий размер колонок и остаток
+        ColumnInput input;                                                      // бюджета памяти архива.
+        for (const auto& column : columns)
+        {
+            input.columns.emplace_back(column);
+        }
+
+        if (limits)
+        {
+            column_limits.input_size = 0;
+            for (const auto& column : columns)
+            {
+                column_limits.input_size += column.size();
+            }
+            column_limits.memory_budget = limits->memory_budget;
+            column_limits.memory_used = limits->memory_used;
+            input.limits = &column_limits;
+        }
+
+        Serializer<ColumnInput> s(input);
+        s.errors = errors;
+        s.options = options;
+        s.dictionary = dictionary;
+        s.pointers = pointers;
+        s.cache = cache;
+        t.clear();
+
+        for (uint32_t i = 0; i < size; i++)                                     // Собираем объекты из колонок построчно.
+        {
+            Item item;
+            input.field = 0;
+            Access::serialize(s, item);
+
+            if (!s.check_input())                                               // Прекращаем десериализацию, если данные колонки
+            {                                                                   // закончились раньше, чем ожидалось.
+                break;
+            }
+            t.push_back(std::move(item));
+        }
+
+        if (limits)
+        {
+            limits->memory_used = column_limits.memory_used;
+        }
+    }
+
+
+    template <typename Base, bool Enable=true>                                  // (20) подставляется для полиморфного указателя Polymorphic,
+    enable_if_t<is_ostream<Stream>::value && Enable>                            // если поток – выходной (см. polymorphic.h).
+    serialize(Polymorphic<Base>& t)                                             // Записывает номер типа и объект. Возвращает void.
+    {
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(Polymorphic<Base>);
+        uint32_t id = t.type_id();
+        serialize(id);
+        if (id)                                                                 // Сериализуем объект функцией из таблицы по номеру типа.
+        {
+            polymorphic_writer(polymorphic_types<Base>(), id)(*this, t.get());
+        }
+    }
+
+
+    template <typename Base, bool Enable=true>                                  // (21) подставляется для полиморфного указателя Polymorphic,
+    enable_if_t<is_istream<Stream>::value && Enable>                            // если поток – входной.
+    serialize(Polymorphic<Base>& t)                                             // Читает номер типа, создает объект этого типа и
+    {                                                                           // десериализует его. Возвращает void.
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(Polymorphic<Base>);
+        uint32_t id = 0;
+        serialize(id);
+        t.reset();
+        if (!check_input() || !id)
+        {
+            return;
+        }
+
+        auto reader = polymorphic_reader(polymorphic_types<Base>(), id);
+        if (!reader)
+        {
+            fail(Status::InvalidData, [&]
+            {
+                std::ostringstream os;
+                os << "Unknown polymorphic type id: " << id
+                   << ". Deserialization failed.";
+                return os.str();
+            });
+            return;
+        }
+        reader(*this, t);
+    }
+
+
+    template <typename T, bool Enable=true>                                     // (22) подставляется для поля Memoized, если поток –
+    enable_if_t<is_ostream<Stream>::value && Enable>                            // выходной (см. encoding_cache.h). Если задан кэш
+    serialize(Memoized<T>& t)                                                   // кодирования, сериализованное представление объекта
+    {                                                                           // берется из кэша. Возвращает void.
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(Memoized<T>);
+        T& object = *t.shared();
+        if (!cache || dictionary || pointers)                                   // Представление, зависящее от состояния архива, не
+        {                                                                       // кэшируется.
+            serialize(object);
+            return;
+        }
+
+        EncodingOptions current = options ? *options : EncodingOptions();
+        const std::string* data = cache->find(t.shared(), t.version(), current);
+        if (!data)                                                              // Сериализуем объект в буфер и сохраняем его в кэше.
+        {
+            ColumnOutputBuffer buffer;
+            Serializer<ColumnOutputBuffer> s(buffer);
+            s.errors = errors;
+            s.options = options;
+            s.cache = cache;
+            s.serialize(object);
+            if (failed())
+            {
+                return;
+            }
+            data = &cache->store(t.shared(), t.version(), current,
+                                 std::move(buffer.data));
+        }
+        write_bytes(data->data(), data->size());
+    }
+
+
+    template <typename T, bool Enable=true>                                     // (23) подставляется для поля Memoized, если поток –
+    enable_if_t<is_istream<Stream>::value && Enable>                            // входной. Создает новый объект (версии 0) и
+    serialize(Memoized<T>& t)                                                   // десериализует его. Возвращает void.
+    {
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(Memoized<T>);
+        claim<T>(1);
+        if (failed())
+        {
+            return;
+        }
+        auto object = std::make_shared<T>();
+        serialize(*object);
+        t = Memoized<T>(object);
+    }
+
+
+    template <typename T>                                                       // (24) подставляется, если:
+    enable_if_t<is_flat_container<T>::value &&                                  // – тип T – FlatSet или FlatMap (см. flat_containers.h); и
+                is_ostream<Stream>::value>                                      // – поток, которым инстанцирован шаблон класса – выходной.
+    serialize(T& t)                                                             // Формат совпадает с std::set и std::map. Возвращает void.
+    {
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        auto size = static_cast<uint32_t>(t.size());
+        SERIALIZATION_STATISTICS_SIZE(T, size);
+        serialize(size);
+        if (write_packed_keys(t, has_packable_keys<T>()))
+        {
+            return;
+        }
+        for (auto& item : t)
+        {
+            serialize_flat_item(item);
+        }
+    }
+
+
+    template <typename T>                                                       // (25) подставляется, если:
+    enable_if_t<is_flat_container<T>::value &&                                  // – тип T – FlatSet или FlatMap; и
+                is_istream<Stream>::value>                                      // – поток, которым инстанцирован шаблон класса – входной.
+    serialize(T& t)                                                             // Элементы читаются в вектор и загружаются в контейнер
+    {                                                                           // одним блоком. Возвращает void.
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        uint32_t size = 0;
+        serialize(size);
+        SERIALIZATION_STATISTICS_SIZE(T, size);
+        if (read_packed_keys(t, size, has_packable_keys<T>()))                  // Упакованные ключи упорядочены и добавляются в конец.
+        {
+            return;
+        }
+
+        using Item = typename T::value_type;
+        bool verified = claim<Item>(size);
+        if (failed())
+        {
+            return;
+        }
+        t.clear();
+
+        std::vector<Item> items;                                                // Как и для вектора, без подтверждения размера размером
+        size_t step = verified ? size : std::max<size_t>(1,                     // потока память выделяется шагами.
+            DecodingLimits::growth_step / sizeof(Item));
+        while (items.size() < size)
+        {
+            size_t begin = items.size();
+            items.resize(std::min<size_t>(size, begin + step));
+
+            for (size_t i = begin; i < items.size(); i++)
+            {
+                serialize_flat_item(items[i]);
+            }
+
+            if (!check_input())
+            {
+                return;
+            }
+        }
+        t.load(std::move(items));
+    }
+
+
+    template <typename T>                                                       // (26) подставляется, если:
+    enable_if_t<is_bit_vector<T>::value &&                                      // – тип T – вектор bool; и
+                is_ostream<Stream>::value>                                      // – поток, которым инстанцирован шаблон класса – выходной.
+    serialize(T& t)                                                             // Записывает количество элементов и биты, упакованные по 8
+    {                                                                           // в байт. Возвращает void.
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        auto size = static_cast<uint32_t>(t.size());
+        SERIALIZATION_STATISTICS_SIZE(T, size);
+        serialize(size);
+        write_bits(size, [&](size_t i) { return bool(t[i]); });
+    }
+
+
+    template <typename T>                                                       // (27) подставляется, если:
+    enable_if_t<is_bit_vector<T>::value &&                                      // – тип T – вектор bool; и
+                is_istream<Stream>::value>                                      // – поток, которым инстанцирован шаблон класса – входной.
+    serialize(T& t)                                                             // Возвращает void.
+    {
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        uint32_t size = 0;
+        serialize(size);
+        SERIALIZATION_STATISTICS_SIZE(T, size);
+
+        bool verified = claim<uint8_t>((uint64_t(size) + 7) / 8);               // Проверяем размер упакованных данных.
+        if (failed())
+        {
+            return;
+        }
+        t.clear();
+        if (verified)                                                           // Без подтверждения размера размером потока вектор растет
+        {                                                                       // по мере чтения блоков.
+            t.reserve(size);
+        }
+        read_bits(size, [&](size_t, bool bit) { t.push_back(bit); });
+    }
+
+
+    template <typename T>                                                       // (28) подставляется, если:
+    enable_if_t<is_std_bitset<T>::value &&                                      // – тип T – std::bitset; и
+                is_ostream<Stream>::value>                                      // – поток, которым инстанцирован шаблон класса – выходной.
+    serialize(T& t)                                                             // Записывает биты, упакованные по 8 в байт (размер известен
+    {                                                                           // на этапе компиляции и не записывается). Возвращает void.
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        write_bits(t.size(), [&](size_t i) { return t[i]; });
+    }
+
+
+    template <typename T>                                                       // (29) подставляется, если:
+    enable_if_t<is_std_bitset<T>::value &&                                      // – тип T – std::bitset; и
+                is_istream<Stream>::value>                                      // – поток, которым инстанцирован шаблон класса – входной.
+    serialize(T& t)                                                             // Возвращает void.
     {
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        t.reset();
+        read_bits(t.size(), [&](size_t i, bool bit) { t[i] = bit; });
+    }
+
+
+    template <typename T>                                                       // (30) подставляется, если:
+    enable_if_t<is_blob_sequence<T>::value &&                                   // – тип T – BlobSequence; и
+                is_ostream<Stream>::value>                                      // – поток, которым инстанцирован шаблон класса – выходной.
+    serialize(T& t)                                                             // Записывает количество элементов, их концы и блок данных
+    {                                                                           // (см. blob_layout.h). Возвращает void.
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        auto size = static_cast<uint32_t>(t.size());
+        SERIALIZATION_STATISTICS_SIZE(T, size);
+        serialize(size);
+        write_array(t.offsets());
+        write_array(t.data());
+    }
+
+
+    template <typename T>                                                       // (31) подставляется, если:
+    enable_if_t<is_blob_sequence<T>::value &&                                   // – тип T – BlobSequence; и
+                is_istream<Stream>::value>                                      // – поток, которым инстанцирован шаблон класса – входной.
+    serialize(T& t)                                                             // Возвращает void.
+    {
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        uint32_t size = 0;
+        serialize(size);
+        SERIALIZATION_STATISTICS_SIZE(T, size);
+
+        std::vector<uint32_t> ends;
+        std::vector<typename T::value_type::value_type> items;
+        if (read_blob(size, ends, items))
+        {
+            t.load(std::move(ends), std::move(items));
+        }
+    }
+
+
+    template <typename T>                                                       // (32) подставляется, если:
+    enable_if_t<is_unsized_range<T>::value &&                                   // – тип T – последовательность без размера (см.
+                is_ostream<Stream>::value>                                      // unsized_range.h); и
+    serialize(T& t)                                                             // – поток, которым инстанцирован шаблон класса – выходной.
+    {                                                                           // Возвращает void.
+        if (failed())
+        {
+            return;
+        }
+        SERIALIZATION_STATISTICS_SCOPE(T);
+        if (!write_unsized(t, is_seekable_ostream<Stream>()))
+        {
+            fail(Status::UnsupportedType, []
+            {
+                return std::string("Unsized ranges require a seekable output "
+                                   "stream. Serialization failed.");
+            });
+        }
+    }
+
+
+    template <typename Key>                                                     // Методы для сериализации элемента FlatSet (ключа) и
+    void serialize_flat_item(Key& key)                                          // FlatMap (ключа и значения).
+    {
+        serialize(key);
+    }
+
+    template <typename Key, typename Value>
+    void serialize_flat_item(std::pair<Key, Value>& item)
+    {
+        serialize(item.first);
+        serialize(item.second);
+    }
+
+
+    template <typename Base>                                                    // Типы функций таблиц записи и чтения полиморфных объектов.
+    using PolymorphicWriter = void (*)(Serializer&, Base*);
+
+    template <typename Base>
+    using PolymorphicReader = void (*)(Serializer&, Polymorphic<Base>&);
+
+    template <typename Base, typename... Derived>                               // Функция для получения функции записи объекта по номеру
+    static PolymorphicWriter<Base>                                              // типа (номер записываемого объекта всегда корректен).
+    polymorphic_writer(PolymorphicTypes<Base, Derived...>, uint32_t id)
+    {
+        static const PolymorphicWriter<Base> writers[] =
+            { &write_derived<Base, Derived>... };
+        return writers[id - 1];
+    }
+
+    template <typename Base, typename... Derived>                               // Функция для получения функции чтения объекта по номеру
+    static PolymorphicReader<Base>                                              // типа (nullptr – номер неизвестен).
+    polymorphic_reader(PolymorphicTypes<Base, Derived...>, uint32_t id)
+    {
+        static const PolymorphicReader<Base> readers[] =
+            { &read_derived<Base, Derived>... };
+        return id <= sizeof...(Derived) ? readers[id - 1] : nullptr;
+    }
+
+    template <typename Base, typename Derived>                                  // Функция для записи объекта наследника Derived.
+    static void write_derived(Serializer& s, Base* ptr)
+    {
+        s.serialize(*static_cast<Derived*>(ptr));
+    }
+
+    template <typename Base, typename Derived>                                  // Функция для создания и чтения объекта наследника Derived
+    static void read_derived(Serializer& s, Polymorphic<Base>& t)               // (память учитывается в бюджете).
+    {
+        s.claim<Derived>(1);
+        if (s.failed())
+        {
+            return;
+        }
+        Derived* ptr = new Derived;
+        t.reset(ptr);
+        s.serialize(*ptr);
+    }
+
+
+    void serialize_columns(std::vector<std::string>& columns)                   // Метод для сериализации колонок как вектора строк: данные
+    {                                                                           // колонок не добавляются в словарь строк (строки полей
+        Serializer s(*this);                                                    // добавляются в него при раскладке по колонкам).
+        s.dictionary = nullptr;
+        s.serialize(columns);
+    }
+
+
+    template <typename T>                                                       // Проверка на необходимость сериализации объекта фиксированного
+    using is_staged = std::integral_constant<bool,                              // размера через буфер на стеке: не используется внутри буфера,
+        !is_fixed_buffer<Stream>::value &&                                      // для слишком больших объектов и для массивов фундаментальных
+        fixed_layout<T>::size <= max_staged_size &&                             // типов (они копируются в поток целиком).
+        !std::is_arithmetic<typename array_element<T>::type>::value>;
+
+    template <typename T>                                                       // Метод для записи объекта фиксированного размера через буфер:
+    void write_fixed(T& t, std::true_type)                                      // поля копируются в буфер, затем буфер записывается в поток
+    {                                                                           // одной операцией.
+        char buffer[fixed_layout<T>::size];
+        FixedOutputBuffer output(buffer, sizeof(buffer));
+
+        Serializer<FixedOutputBuffer> s(output);
+        s.errors = errors;
+#ifdef SERIALIZATION_STATISTICS
+        s.statistics = statistics;
+#endif
+        s.serialize_fields(t);
+        bool consumed = !output.overflow && output.cursor == output.end;
+        if (!check_fixed_layout<T>(consumed, "Serialization"))
+        {
+            return;
+        }
+
+        stream.write(buffer, sizeof(buffer));
+    }
+
+    template <typename T>                                                       // Метод для записи объекта фиксированного размера
+    void write_fixed(T& t, std::false_type)                                     // непосредственно в поток.
+    {
+        serialize_fields(t);
+    }
+
+    template <typename T>                                                       // Метод для чтения объекта фиксированного размера через буфер:
+    void read_fixed(T& t, std::true_type)                                       // данные объекта читаются из потока одной операцией с одной
+    {                                                                           // проверкой границ, затем поля копируются из буфера без проверок.
+        char buffer[fixed_layout<T>::size];
+        stream.read(buffer, sizeof(buffer));
+
+        if (limits)
+        {
+            limits->consumed += sizeof(buffer);
+        }
+
+        if (!check_input())
+        {
+            return;
+        }
+
+        FixedInputBuffer input(buffer, sizeof(buffer));
+        Serializer<FixedInputBuffer> s(input);
+        s.errors = errors;
+#ifdef SERIALIZATION_STATISTICS
+        s.statistics = statistics;
+#endif
+        s.serialize_fields(t);
+        bool consumed = !input.overflow && input.cursor == input.end;
+        check_fixed_layout<T>(consumed, "Deserialization");
+    }
+
+    template <typename T>                                                       // Метод для проверки, что метод serialize записал (прочитал)
+    bool check_fixed_layout(bool consumed, const char* operation)               // ровно объявленный в fixed_layout размер. Возвращает false,
+    {                                                                           // если сериализацию нужно прекратить.
+        if (!failed() && !consumed)
+        {
+            fail(Status::InvalidData, [&]
+            {
+                std::ostringstream os;
+                os << "Serialized fields do not match the declared fixed "
+                   << "layout of " << fixed_layout<T>::size << " bytes. "
+                   << operation << " failed.";
+                return os.str();
+            });
+        }
+        return !failed();
+    }
+
+    template <typename T>                                                       // Метод для чтения объекта фиксированного размера
+    void read_fixed(T& t, std::false_type)                                      // непосредственно из потока.
+    {
+        serialize_fields(t);
+        check_input();
+    }
+
+    template <typename T>                                                       // Метод для сериализации полей пользовательского класса
+    enable_if_t<is_serializable<T>::value>                                      // фиксированного размера.
+    serialize_fields(T& t)
+    {
+        Access::serialize(*this, t);
+    }
+
+    template <typename T>                                                       // Метод для сериализации элементов статического массива
+    enable_if_t<is_std_array<T>::value &&                                       // фиксированного размера (без префикса длины).
+                !std::is_arithmetic<typename T::value_type>::value>
+    serialize_fields(T& t)
+    {
+        for (auto& item : t)
+        {
+            serialize(item);
+        }
+    }
+
+    template <typename T>                                                       // Метод для записи статического массива фундаментальных
+    enable_if_t<is_std_array<T>::value &&                                       // типов целиком одной операцией.
+                std::is_arithmetic<typename T::value_type>::value &&
+                is_ostream<Stream>::value>
+    serialize_fields(T& t)
+    {
+        write_bytes(reinterpret_cast<const char*>(t.data()),
+                    t.size() * sizeof(typename T::value_type));
+    }
+
+    template <typename T>                                                       // Метод для чтения статического массива фундаментальных
+    enable_if_t<is_std_array<T>::value &&                                       // типов целиком одной операцией.
+                std::is_arithmetic<typename T::value_type>::value &&
+                is_istream<Stream>::value>
+    serialize_fields(T& t)
+    {
+        read_bytes(reinterpret_cast<char*>(t.data()),
+                   t.size() * sizeof(typename T::value_type));
+    }
+
+
+    void serialize_members(std::false_type) {}                                  // Методы для сериализации полей, переданных оператору ():
+
+    template <typename T, typename... Rest>                                     // поле, не являющееся фундаментальным, сериализуется
+    enable_if_t<!std::is_arithmetic<T>::value>                                  // обычным образом;
+    serialize_members(std::false_type, T& t, Rest&... rest)
+    {
+        serialize(t);
+        serialize_members(std::false_type(), rest...);
+    }
+
+    template <typename T, typename... Rest>                                     // подряд идущие фундаментальные поля объединяются в одну
+    enable_if_t<std::is_arithmetic<T>::value>                                   // операцию записи (чтения) размером fundamental_run;
+    serialize_members(std::false_type, T& t, Rest&... rest)
+    {
+        char buffer[fundamental_run<T, Rest...>::value] = {};
+        begin_run(buffer, sizeof(buffer));
+        stage_members(buffer, buffer, t, rest...);
+    }
+
+    template <typename... T>                                                    // при поколоночной сериализации каждое поле записывается
+    void serialize_members(std::true_type, T&... t)                             // в свою колонку.
+    {
+        int expand[] = { 0, (serialize_member(t, std::true_type()), 0)... };
+        (void)expand;
+    }
+
+    void stage_members(char* buffer, char* cursor)                              // Методы для копирования полей серии в буфер (из буфера):
+    {                                                                           // после последнего фундаментального поля буфер
+        end_run(buffer, size_t(cursor - buffer));                               // записывается, а остальные поля сериализуются дальше.
+    }
+
+    template <typename T, typename... Rest>
+    enable_if_t<std::is_arithmetic<T>::value>
+    stage_members(char* buffer, char* cursor, T& t, Rest&... rest)
+    {
+        stage_member(cursor, t);
+        stage_members(buffer, cursor + sizeof(T), rest...);
+    }
+
+    template <typename T, typename... Rest>
+    enable_if_t<!std::is_arithmetic<T>::value>
+    stage_members(char* buffer, char* cursor, T& t, Rest&... rest)
+    {
+        end_run(buffer, size_t(cursor - buffer));
+        serialize_members(std::false_type(), t, rest...);
+    }
+
+    template <bool Enable=true>                                                 // Методы начала серии (чтение буфера), копирования поля
+    enable_if_t<is_ostream<Stream>::value && Enable>                            // и конца серии (запись буфера).
+    begin_run(char*, size_t) {}
+
+    template <bool Enable=true>
+    enable_if_t<is_istream<Stream>::value && Enable>
+    begin_run(char* buffer, size_t size)
+    {
+        read_bytes(buffer, size);
+    }
+
+    template <typename T>
+    void stage_member(char* cursor, T& t)
+    {
+        if (is_ostream<Stream>::value)
+        {
+            std::memcpy(cursor, &t, sizeof(T));
+        }
+        else
+        {
+            std::memcpy(&t, cursor, sizeof(T));
+        }
+    }
+
+    template <bool Enable=true>
+    enable_if_t<is_ostream<Stream>::value && Enable>
+    end_run(char* buffer, size_t size)
+    {
+        write_bytes(buffer, size);
+    }
+
+    template <bool Enable=true>
+    enable_if_t<is_istream<Stream>::value && Enable>
+    end_run(char*, size_t) {}
+
+    template <typename T>                                                       // Метод для сериализации поля объекта (вызывается оператором &).
+    void serialize_member(T& t, std::false_type)
+    {
+        serialize(t);
+    }
+
+    template <typename T>                                                       // Метод для сериализации поля объекта в очередную колонку
+    void serialize_member(T& t, std::true_type)                                 // (при поколоночной сериализации): поле сериализуется
+    {                                                                           // сериализатором буфера колонки.
+        Serializer<typename Stream::stream_type> s(stream.next());
+        s.limits = stream.limits;
+        s.errors = errors;
+        s.options = options;
+        s.dictionary = dictionary;
+        s.pointers = pointers;
+        s.cache = cache;
+        s.serialize(t);
+    }
+
+    template <typename T>                                                       // Метод для записи контейнера без упаковки ключей.
+    bool write_packed_keys(T&, std::false_type)
+    {
+        return false;
+    }
+
+    template <typename T>                                                       // Метод для записи упорядоченного контейнера с упакованными
+    bool write_packed_keys(T& t, std::true_type)                                // ключами (см. bit_packing.h): первый ключ, затем блоки
+    {                                                                           // разностей, затем значения (для отображений).
+        if (!options || !options->packed_keys)                                  // Возвращает false, если упаковка выключена.
+        {
+            return false;
+        }
+
+        auto it = t.begin();
+        if (it == t.end())
+        {
+            return true;
+        }
+
+        auto key = packed_key(*it);
+        serialize(key);
+        auto previous = static_cast<uint64_t>(key);
+
+        uint64_t deltas[packed_block_size];
+        char packed[packed_block_size * sizeof(uint64_t)];
+
+        for (++it; it != t.end(); )                                             // Упаковываем разности блоками.
+        {
+            size_t count = 0;
+            uint64_t max_delta = 0;
+            for (; it != t.end() && count < packed_block_size; ++it)
+            {
+                auto current = static_cast<uint64_t>(packed_key(*it));
+                deltas[count] = current - previous;
+                max_delta = std::max(max_delta, deltas[count++]);
+                previous = current;
+            }
+
+            auto width = static_cast<uint8_t>(bit_width(max_delta));
+            serialize(width);
+            pack_bits(deltas, count, width, packed);
+            write_bytes(packed, packed_bytes(count, width));
+        }
+
+        serialize_values(t);
+        return true;
+    }
+
+    template <typename T>                                                       // Метод для чтения контейнера без упаковки ключей.
+    bool read_packed_keys(T&, uint32_t, std::false_type)
+    {
+        return false;
+    }
+
+    template <typename T>                                                       // Метод для чтения упорядоченного контейнера с упакованными
+    bool read_packed_keys(T& t, uint32_t size, std::true_type)                  // ключами. Возвращает false, если упаковка выключена.
+    {
+        if (!options || !options->packed_keys)
+        {
+            return false;
+        }
+
+        using Item = typename T::value_type;                                    // Упакованные ключи могут занимать меньше байта: проверяем
+        claim<Item>(size, min_encoded_size<Item>::value -                       // только размер значений отображения.
+                          min_encoded_size<typename T::key_type>::value);
+        if (failed())
+        {
+            return true;
+        }
+        t.clear();
+
+        std::vector<typename T::key_type> keys;
+        typename T::key_type key = 0;
+        if (size)
+        {
+            serialize(key);
+            keys.push_back(key);
+        }
+        auto previous = static_cast<uint64_t>(key);
+
+        uint64_t deltas[packed_block_size];
+        char packed[packed_block_size * sizeof(uint64_t)];
+
+        while (keys.size() < size)                                              // Распаковываем разности блоками и проверяем поток после
+        {                                                                       // каждого блока.
+            size_t count = std::min<size_t>(packed_block_size,
+                                            size - keys.size());
+            uint8_t width = 0;
+            serialize(width);
+            if (width > max_packed_width)
+            {
+                fail(Status::InvalidData, [&]
+                {
+                    std::ostringstream os;
+                    os << "Invalid packed key width: " << int(width)
+                       << ". Deserialization failed.";
+                    return os.str();
+                });
+                return true;
+            }
+
+            read_bytes(packed, packed_bytes(count, width));
+            if (!check_input())
+            {
+                return true;
+            }
+
+            unpack_bits(packed, count, width, deltas);
+            for (size_t i = 0; i < count; i++)
+            {
+                previous += deltas[i];
+                keys.push_back(static_cast<typename T::key_type>(previous));
+            }
+        }
+
+        if (check_input())
+        {
+            deserialize_values(t, keys);
+        }
+        return true;
+    }
+
+    template <typename Key>                                                     // Методы для записи значений отображения с упакованными
+    void serialize_values(std::set<Key>&) {}                                    // ключами (у множеств значений нет).
+
+    template <typename Key>
+    void serialize_values(std::multiset<Key>&) {}
+
+    template <typename Key, typename Compare>
+    void serialize_values(FlatSet<Key, Compare>&) {}
+
+    template <typename T>
+    void serialize_values(T& t)
+    {
+        for (auto& item : t)
+        {
+            serialize(item.second);
+        }
+    }
+
+    template <typename T, typename Key>                                         // Методы для заполнения контейнера распакованными ключами
+    enable_if_t<std::is_same<typename T::value_type, Key>::value>               // (и значениями, прочитанными из потока, для отображений).
+    deserialize_values(T& t, const std::vector<Key>& keys)                      // Ключи упорядочены, поэтому вставляются в конец.
+    {
+        for (const auto& key : keys)
+        {
+            t.emplace_hint(t.end(), key);
+        }
+    }
+
+    template <typename T, typename Key>
+    enable_if_t<!std::is_same<typename T::value_type, Key>::value>
+    deserialize_values(T& t, const std::vector<Key>& keys)
+    {
+        for (const auto& key : keys)
+        {
+            typename T::mapped_type value;
+            serialize(value);
+            if (!check_input())
+            {
+                return;
+            }
+            t.emplace_hint(t.end(), key, std::move(value));
+        }
+    }
+
+    template <typename T>                                                       // Метод для записи последовательности без сжатия.
+    bool write_compressed_floats(T&, std::false_type, uint64_t* = nullptr)
+    {
+        return false;
+    }
+
+    template <typename T>                                                       // Метод для записи последовательности чисел с плавающей
+    bool write_compressed_floats(T& t, std::true_type,                          // точкой, сжатой XOR с предыдущим значением (см.
+                                 uint64_t* count = nullptr)                     // float_compression.h): размер сжатых данных и сами данные.
+    {                                                                           // Возвращает false, если сжатие выключено. В count
+        if (!options || !options->compressed_floats)                            // записывается количество значений.
+        {
+            return false;
+        }
+
+        XorEncoder<typename T::value_type> encoder;
+        uint64_t added = 0;
+        for (auto item : t)
+        {
+            encoder.add(item);
+            added++;
+        }
+        if (count)
+        {
+            *count = added;
+        }
+
+        std::string& data = encoder.finish();
+        auto bytes = static_cast<uint32_t>(data.size());
+        serialize(bytes);
+        write_bytes(data.data(), data.size());
+        return true;
+    }
+
+    template <typename T>                                                       // Метод для чтения последовательности без сжатия.
+    bool read_compressed_floats(T&, uint32_t, std::false_type)
+    {
+        return false;
+    }
+
+    template <typename T>                                                       // Метод для чтения сжатой последовательности чисел
+    bool read_compressed_floats(T& t, uint32_t size, std::true_type)            // с плавающей точкой. Возвращает false, если сжатие
+    {                                                                           // выключено.
+        if (!options || !options->compressed_floats)
+        {
+            return false;
+        }
+
+        using Item = typename T::value_type;
+        uint32_t bytes = 0;
+        serialize(bytes);
+        if (!check_input())
+        {
+            return true;
+        }
+
+        if (size && uint64_t(bytes) * 8 < sizeof(Item) * 8 + size - 1)          // Каждое значение, кроме первого, занимает хотя бы один бит.
+        {
+            fail(Status::InvalidData, [&]
+            {
+                std::ostringstream os;
+                os << "Compressed size " << bytes << " is too small for "
+                   << size << " values. Deserialization failed.";
+                return os.str();
+            });
+            return true;
+        }
+
+        claim<char>(bytes);
+        claim<Item>(size, 0);
+        if (failed())
+        {
+            return true;
+        }
+
+        std::string data;                                                       // Читаем сжатые данные шагами (размер мог быть не подтвержден
+        while (data.size() < bytes)                                             // размером потока).
+        {
+            size_t begin = data.size();
+            data.resize(std::min<size_t>(bytes,
+                                         begin + DecodingLimits::growth_step));
+            read_bytes(&data[begin], data.size() - begin);
+            if (!check_input())
+            {
+                return true;
+            }
+        }
+
+        std::vector<Item> values(size);
+        XorDecoder<Item> decoder(data.data(), data.size());
+        for (auto& value : values)
+        {
+            if (!decoder.next(value))
+            {
+                fail(Status::InvalidData, []
+                {
+                    return std::string("Invalid compressed floating-point "
+                                       "data. Deserialization failed.");
+                });
+                return true;
+            }
+        }
+
+        t.assign(values.begin(), values.end());
+        return true;
+    }
+
+    template <typename T>                                                       // Метод для потоков, в которых нельзя перезаписать данные.
+    bool write_unsized(T&, std::false_type)
+    {
+        return false;
+    }
+
+    template <typename T>                                                       // Метод для записи последовательности за один проход:
+    bool write_unsized(T& t, std::true_type)                                    // резервирует место под размер, записывает элементы и
+    {                                                                           // дописывает их количество. Возвращает false (ничего не
+        int64_t position = output_position(stream);                             // записывая), если поток не поддерживает позиционирование.
+        if (position < 0)
+        {
+            return false;
+        }
+
+        uint32_t size = 0;
+        serialize(size);
+        uint64_t count = 0;
+        if (!write_compressed_floats(t, is_float_sequence<T>(), &count))
+        {
+            using Item = typename T::value_type;
+            for (auto& item : t)                                                // Элементы входных итераторов могут быть константными.
+            {
+                serialize(*const_cast<Item*>(&item));
+                count++;
+            }
+        }
+        if (count > std::numeric_limits<uint32_t>::max())
+        {
+            fail(Status::InvalidData, []
+            {
+                return std::string("Sequence size exceeds 2^32 items. "
+                                   "Serialization failed.");
+            });
+            return true;
+        }
+
+        size = static_cast<uint32_t>(count);
+        SERIALIZATION_STATISTICS_SIZE(T, size);
+        patch_output(stream, position, reinterpret_cast<const char*>(&size),
+                     sizeof(size));
+        return true;
+    }
+
+    template <typename Item>                                                    // Метод для проверки, включена ли раскладка «смещения и
+    bool blob_layout_enabled() const                                            // блок данных» для элементов типа Item (к строкам она
+    {                                                                           // не применяется при включенном словаре строк).
+        return options && options->blob_layout &&
+               !(dictionary && std::is_same<Item, std::string>::value);
+    }
+
+    template <typename T>                                                       // Метод для записи массива фундаментальных значений одной
+    void write_array(const T& t)                                                // операцией (без префикса длины).
+    {
+        write_bytes(reinterpret_cast<const char*>(t.data()),
+                    t.size() * sizeof(typename T::value_type));
+    }
+
+    template <typename Item>                                                    // Метод для чтения count фундаментальных значений в вектор
+    bool read_array(std::vector<Item>& v, uint64_t count)                       // одной операцией (или шагами DecodingLimits::growth_step
+    {                                                                           // байт, если размер не подтвержден размером потока).
+        bool verified = claim<Item>(count);                                     // Возвращает false при ошибке.
+        if (failed())
+        {
+            return false;
+        }
+
+        size_t step = std::max<size_t>(1, DecodingLimits::growth_step /
+                                          sizeof(Item));
+        if (verified)
+        {
+            step = count;
+        }
+        v.clear();
+        while (v.size() < count)
+        {
+            size_t begin = v.size();
+            v.resize(std::min<uint64_t>(count, begin + step));
+            read_bytes(reinterpret_cast<char*>(v.data() + begin),
+                       (v.size() - begin) * sizeof(Item));
+            if (!check_input())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename Item>                                                    // Метод для чтения концов size элементов и блока данных
+    bool read_blob(uint32_t size, std::vector<uint32_t>& ends,                  // (см. blob_layout.h). Возвращает false при ошибке.
+                   std::vector<Item>& items)
+    {
+        if (!read_array(ends, size))
+        {
+            return false;
+        }
+        if (!valid_blob_ends(ends))
+        {
+            fail(Status::InvalidData, []
+            {
+                return std::string("Invalid blob layout offsets. "
+                                   "Deserialization failed.");
+            });
+            return false;
+        }
+        return read_array(items, ends.empty() ? 0 : ends.back());
+    }
+
+    template <typename T>                                                       // Метод для записи остальных последовательностей.
+    bool write_blob_layout(T&, std::false_type)
+    {
+        return false;
+    }
+
+    template <typename T>                                                       // Метод для записи вектора строк или векторов в раскладке
+    bool write_blob_layout(T& t, std::true_type)                                // «смещения и блок данных»: концы элементов и данные всех
+    {                                                                           // элементов подряд. Возвращает false, если раскладка
+        using Inner = typename T::value_type;                                   // выключена.
+        if (!blob_layout_enabled<Inner>())
+        {
+            return false;
+        }
+
+        std::vector<uint32_t> ends;
+        ends.reserve(t.size());
+        uint64_t total = 0;
+        for (auto& inner : t)
+        {
+            total += inner.size();
+            ends.push_back(static_cast<uint32_t>(total));
+        }
+        if (total > std::numeric_limits<uint32_t>::max())
+        {
+            fail(Status::InvalidData, []
+            {
+                return std::string("Blob layout data exceeds 2^32 items. "
+                                   "Serialization failed.");
+            });
+            return true;
+        }
+
+        write_array(ends);
+        for (auto& inner : t)
+        {
+            write_array(inner);
+        }
+        return true;
+    }
+
+    template <typename T>                                                       // Метод для чтения остальных последовательностей.
+    bool read_blob_layout(T&, uint32_t, std::false_type)
+    {
+        return false;
+    }
+
+    template <typename T>                                                       // Метод для чтения вектора строк или векторов в раскладке
+    bool read_blob_layout(T& t, uint32_t size, std::true_type)                  // «смещения и блок данных»: данные читаются одним блоком
+    {                                                                           // и копируются в элементы. Возвращает false, если
+        using Inner = typename T::value_type;                                   // раскладка выключена.
+        if (!blob_layout_enabled<Inner>())
+        {
+            return false;
+        }
+
+        claim<Inner>(size, 0);                                                  // Учитываем память под сами элементы.
+        std::vector<uint32_t> ends;
+        std::vector<typename Inner::value_type> items;
+        if (failed() || !read_blob(size, ends, items))
+        {
+            return true;
+        }
+
+        t.resize(size);
+        uint32_t begin = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            t[i].assign(items.data() + begin, items.data() + ends[i]);
+            begin = ends[i];
+        }
+        return true;
+    }
+
+    template <typename T>                                                       // Методы для записи ссылки на строку из словаря архива:
+    bool write_string_reference(T&, std::false_type)                            // возвращают true, если строка уже записана в словарь
+    {                                                                           // (записана только ссылка), и false, если строку нужно
+        return false;                                                           // записать целиком (словарь выключен или строка новая).
+    }
+
+    bool write_string_reference(std::string& t, std::true_type)
+    {
+        if (!dictionary)
+        {
+            return false;
+        }
+
+        auto next = static_cast<uint32_t>(dictionary->indices.size() + 1);
+        auto entry = dictionary->indices.emplace(t, next);
+        uint32_t reference = entry.second ? 0 : entry.first->second;
+        serialize(reference);
+        return !entry.second;
+    }
+
+    template <typename T>                                                       // Методы для чтения строки со ссылкой на словарь архива:
+    bool read_string_reference(T&, std::false_type)                             // возвращают false, если словарь выключен (строку нужно
+    {                                                                           // прочитать целиком).
+        return false;
+    }
+
+    bool read_string_reference(std::string& t, std::true_type)
+    {
+        if (!dictionary)
+        {
+            return false;
+        }
+
+        uint32_t reference = 0;
+        serialize(reference);
+        if (!check_input())
+        {
+            return true;
+        }
+
+        auto& strings = dictionary->strings;
+        if (reference == 0)                                                     // Новая строка: читаем ее и добавляем в словарь.
+        {
+            read_sequence(t);
+            if (!failed())
+            {
+                claim<char>(t.size(), 0);
+            }
+            if (!failed())
+            {
+                strings.push_back(t);
+            }
+            return true;
+        }
+
+        if (reference > strings.size())
+        {
+            fail(Status::InvalidData, [&]
+            {
+                std::ostringstream os;
+                os << "Invalid string reference: " << reference
+                   << " (dictionary size " << strings.size()
+                   << "). Deserialization failed.";
+                return os.str();
+            });
+            return true;
+        }
+
+        const std::string& value = strings[reference - 1];                      // Копируем строку из словаря (память учитывается в бюджете).
+        claim<char>(value.size(), 0);
+        if (!failed())
+        {
+            t = value;
+        }
+        return true;
+    }
+
+    template <typename T>                                                       // Метод для записи ссылки на разделяемый объект из таблицы
+    bool write_pointer_reference(Pointer<T>& t)                                 // архива: возвращает true, если объект уже записан (записана
+    {                                                                           // только ссылка), и false, если объект нужно записать
+        if (!pointers)                                                          // целиком (таблица выключена или объект новый).
+        {
+            return false;
+        }
+
+        auto next = static_cast<uint32_t>(pointers->indices.size() + 1);
+        auto entry = pointers->indices.emplace(
+            PointerTable::Key(t.ptr, pointer_type_tag<T>(), t.size), next);
+        uint32_t reference = entry.second ? 0 : entry.first->second;
+        serialize(reference);
+        return !entry.second;
+    }
+
+    template <typename T>                                                       // Метод для чтения ссылки на разделяемый объект: возвращает
+    bool read_pointer_reference(Pointer<T>& t)                                  // true, если указатель прочитан (ссылка на прочитанный
+    {                                                                           // объект или ошибка), и false, если данные объекта нужно
+        if (!pointers)                                                          // прочитать (таблица выключена или объект новый).
+        {
+            return false;
+        }
+
+        uint32_t reference = 0;
+        serialize(reference);
+        if (check_input() && reference == 0)
+        {
+            return false;
+        }
+
+        const auto& entries = pointers->entries;
+        if (!failed() &&
+            (reference > entries.size() ||
+             entries[reference - 1].type != pointer_type_tag<T>()))
+        {
+            fail(Status::InvalidData, [&]
+            {
+                std::ostringstream os;
+                os << "Invalid shared object reference: " << reference
+                   << " (table size " << entries.size()
+                   << "). Deserialization failed.";
+                return os.str();
+            });
+        }
+
+        if (failed())                                                           // При ошибке считаем указатель пустым.
+        {
+            t.ptr = nullptr;
+            t.size = 0;
+            t.alloc_type = AllocType::Empty;
+            return true;
+        }
+
+        const auto& entry = entries[reference - 1];                             // Указатель ссылается на объект, которым владеет первый
+        t.ptr = static_cast<T*>(entry.ptr);                                     // прочитанный указатель.
+        t.size = entry.size;
+        t.alloc_type = AllocType::Shared;
+        return true;
+    }
+
+    template <typename T>                                                       // Метод для добавления прочитанного объекта в таблицу.
+    void remember_pointer(Pointer<T>& t)
+    {
+        if (pointers)
+        {
+            pointers->entries.push_back({ t.ptr, pointer_type_tag<T>(), t.size });
+        }
+    }
+
+    template <typename T>                                                       // Метод для десериализации вектора или строки (см. (5)).
+    void read_sequence(T& t)
+    {
+        uint32_t size = 0;                                                      // Создаем переменную для размера контейнера и
+        serialize(size);                                                        // десериализуем в нее данные о размере.
+        SERIALIZATION_STATISTICS_SIZE(T, size);
+        if (read_compressed_floats(t, size, is_float_sequence<T>()) ||          // Распаковываем числа с плавающей точкой или читаем
+            read_blob_layout(t, size, is_nested_contiguous<T>()))               // смещения и блок данных, если это включено.
+        {
+            return;
+        }
+
+        using Item = typename T::value_type;
+        bool verified = claim<Item>(size);
+        if (failed())
+        {
+            return;
+        }
+
+        if (verified)                                                           // Если размер подтвержден размером потока,
+        {
+            t.resize(size);                                                     // изменяем размер десериализуемого контейнера сразу.
+
+            for (auto& item : t)                                                // Итерируемся по контейнеру и десериализуем его поэлементно.
+            {
+                serialize(item);
+            }
+            check_input();
+            return;
+        }
+
+        t.clear();                                                              // Иначе увеличиваем размер контейнера шагами не более
+        size_t step = std::max<size_t>(1, DecodingLimits::growth_step /         // DecodingLimits::growth_step байт по мере поступления
+                                          sizeof(Item));                        // данных, чтобы поврежденный размер не приводил к выделению
+                                                                                // памяти, которой не соответствуют данные в потоке.
+        while (t.size() < size)
+        {
+            size_t begin = t.size();
+            t.resize(std::min<size_t>(size, begin + step));
+
+            for (size_t i = begin; i < t.size(); i++)
+            {
+                serialize(t[i]);
+            }
+
+            if (!check_input())
+            {
+                return;
+            }
+        }
+    }
+
+    template <typename T>                                                       // Метод для передачи потоку ссылки на элементы вектора
+    bool write_contiguous(T& t, std::true_type)                                 // или строки вместо их поэлементного копирования (байты
+    {                                                                           // совпадают с поэлементной записью).
+        size_t size = t.size() * sizeof(typename T::value_type);
+        stream.write_reference(reinterpret_cast<const char*>(t.data()), size);
+        SERIALIZATION_STATISTICS_BYTES(size);
+        return true;
+    }
+
+    template <typename T>                                                       // Метод для остальных контейнеров и потоков.
+    bool write_contiguous(T&, std::false_type)
+    {
+        return false;
+    }
+
+    template <typename Get>                                                     // Метод для записи count бит, возвращаемых get(i): биты
+    void write_bits(size_t count, Get get)                                      // собираются в машинные слова (младшие биты – первыми)
+    {                                                                           // и записываются блоками по bit_block_words слов.
+        uint64_t words[bit_block_words];
+        const size_t block_bits = sizeof(words) * 8;
+        for (size_t begin = 0; begin < count; begin += block_bits)
+        {
+            size_t bits = std::min(count - begin, block_bits);
+            std::fill(words, words + (bits + 63) / 64, 0);
+            for (size_t i = 0; i < bits; i++)
+            {
+                words[i / 64] |= uint64_t(get(begin + i)) << (i % 64);
+            }
+            write_bytes(reinterpret_cast<const char*>(words), (bits + 7) / 8);
+        }
+    }
+
+    template <typename Set>                                                     // Метод для чтения count бит блоками с вызовом set(i, bit)
+    void read_bits(size_t count, Set set)                                       // для каждого бита. Чтение прекращается при ошибке.
+    {
+        uint64_t words[bit_block_words];
+        const size_t block_bits = sizeof(words) * 8;
+        for (size_t begin = 0; begin < count; begin += block_bits)
+        {
+            size_t bits = std::min(count - begin, block_bits);
+            std::fill(words, words + (bits + 63) / 64, 0);
+            read_bytes(reinterpret_cast<char*>(words), (bits + 7) / 8);
+            if (!check_input())
+            {
+                return;
+            }
+            for (size_t i = 0; i < bits; i++)
+            {
+                set(begin + i, ((words[i / 64] >> (i % 64)) & 1) != 0);
+            }
+        }
+    }
+
+    template <typename T>                                                       // Метод для сериализации (только запись в поток) контейнера,
+    void serialize_container(T& t)                                              // поддерживающего range-based for loop.
+    {
+        if (write_contiguous(t, std::integral_constant<bool,                    // Непрерывный массив передаем потоку по ссылке (если поток
+                is_gather_ostream<Stream>::value &&                             // это поддерживает).
+                is_contiguous_arithmetic<T>::value>()))
+        {
+            return;
+        }
         for (auto& item : t)                                                    // Итерируемся по контейнеру с обращением к элементу по ссылке и
         {                                                                       // сериализуем каждый элемент
             serialize(item);
         }
     }
-};
+};
\ No newline at end of file
@@ -0,0 +1,228 @@
+/*  Классы ShardedWriter и ShardedReader – архив, разделенный на
+    несколько файлов (шардов), которые записываются и читаются
+    параллельно (например, файлы на разных дисках):
+
+        ShardedWriter writer({ "/disk1/data.0", "/disk2/data.1" });
+        writer.write(objects, "data.manifest");
+
+        ShardedReader reader("data.manifest");
+        reader.read(objects);
+
+    Контейнер объектов (вектор, дек, лист) делится на непрерывные части
+    примерно одинакового размера по количеству объектов, и каждая часть
+    сериализуется в свой файл отдельным потоком выполнения обычным
+    архивом (объекты записываются друг за другом). Манифест – небольшой
+    файл с именами файлов шардов и количеством объектов в каждом:
+    по нему читатель параллельно десериализует шарды и собирает
+    контейнер в исходном порядке.
+    Ошибки открытия и записи файлов приводят к исключениям
+    std::runtime_error, ошибки в манифесте – std::invalid_argument.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "serialization.h"
+#include "worker_threads.h"
+
+struct ShardManifest                                                            // Манифест шардов (записывается в файл с помощью Archive).
+{                                                                               // Поля:
+    std::vector<std::string> files;                                             // - имена файлов шардов;
+    std::vector<uint64_t> counts;                                               // - количество объектов в каждом шарде.
+
+private:
+    friend struct Access;
+
+    template <typename Stream>
+    void serialize(Serializer<Stream> s)
+    {
+        s & files;
+        s & counts;
+    }
+};
+
+template <typename Task>                                                        // Функция для выполнения task(i) для каждого шарда в своем
+void run_shards(size_t count, Task task)                                        // потоке (шард 0 – в текущем). Первое исключение
+{                                                                               // выбрасывается после завершения всех потоков.
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&](size_t shard)
+    {
+        try
+        {
+            task(shard);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    {
+        WorkerThreads workers;                                                  // Запущенные потоки дожидаются и при ошибке запуска
+        for (size_t i = 1; i < count; i++)                                      // следующего потока.
+        {
+            workers.start(worker, i);
+        }
+        if (count)
+        {
+            worker(0);
+        }
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+template <typename File>                                                        // Функция для открытия файла шарда или манифеста.
+File open_shard_file(const std::string& path)
+{
+    File file(path, std::ios_base::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Cannot open shard file '" + path + "'.");
+    }
+    return file;
+}
+
+class ShardedWriter
+{
+public:
+    explicit ShardedWriter(std::vector<std::string> files)                      // Конструктор с именами файлов шардов (по одному потоку
+        : files(std::move(files))                                               // на файл).
+    {
+        if (this->files.empty())
+        {
+            throw std::invalid_argument("At least one shard file is required.");
+        }
+    }
+
+    template <typename Container>                                               // Метод для записи объектов контейнера в шарды и манифеста
+    ShardManifest write(Container& objects,                                     // в файл manifest_path. Возвращает манифест.
+                        const std::string& manifest_path)
+    {
+        ShardManifest manifest;
+        manifest.files = files;
+
+        using Iterator = typename Container::iterator;                          // Делим контейнер на непрерывные части.
+        std::vector<Iterator> bounds;
+        auto it = objects.begin();
+        size_t size = objects.size();
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            bounds.push_back(it);
+            uint64_t count = (i + 1) * size / files.size() -
+                             i * size / files.size();
+            manifest.counts.push_back(count);
+            std::advance(it, count);
+        }
+        bounds.push_back(it);
+
+        run_shards(files.size(), [&](size_t shard)
+        {
+            auto output = open_shard_file<std::ofstream>(files[shard]);
+            {
+                Archive<std::ofstream> archive(output);
+                for (auto item = bounds[shard]; item != bounds[shard + 1];
+                     ++item)
+                {
+                    archive << *item;
+                }
+            }
+            close(output, files[shard]);
+        });
+
+        auto output = open_shard_file<std::ofstream>(manifest_path);            // Манифест записывается последним: при ошибке записи
+        {                                                                       // шардов он не создается.
+            Archive<std::ofstream> archive(output);
+            archive << manifest;
+        }
+        close(output, manifest_path);
+        return manifest;
+    }
+
+private:
+    static void close(std::ofstream& output, const std::string& path)           // Функция для закрытия файла с проверкой ошибок записи.
+    {
+        output.close();
+        if (!output)
+        {
+            throw std::runtime_error("Cannot write shard file '" + path + "'.");
+        }
+    }
+
+    std::vector<std::string> files;                                             // Имена файлов шардов.
+};
+
+class ShardedReader
+{
+public:
+    explicit ShardedReader(const std::string& manifest_path)                    // Конструктор с именем файла манифеста (манифест читается
+    {                                                                           // и проверяется сразу).
+        auto input = open_shard_file<std::ifstream>(manifest_path);
+        Archive<std::ifstream> archive(input);
+        archive >> shards;
+
+        if (shards.files.size() != shards.counts.size())
+        {
+            throw std::invalid_argument("Shard manifest is inconsistent. "
+                                        "Deserialization failed.");
+        }
+    }
+
+    const ShardManifest& manifest() const
+    {
+        return shards;
+    }
+
+    template <typename Container>                                               // Метод для чтения объектов из шардов в контейнер
+    void read(Container& objects)                                               // (вектор, дек или лист) в исходном порядке.
+    {
+        using Item = typename Container::value_type;
+        std::vector<std::vector<Item>> parts(shards.files.size());
+
+        run_shards(parts.size(), [&](size_t shard)
+        {
+            auto input = open_shard_file<std::ifstream>(shards.files[shard]);
+            Archive<std::ifstream> archive(input);
+            for (uint64_t i = 0; i < shards.counts[shard]; i++)
+            {
+                Item item;
+                archive >> item;
+                if (!input)                                                     // Количество объектов в манифесте больше, чем в файле.
+                {
+                    throw std::invalid_argument("Shard file '" +
+                                                shards.files[shard] +
+                                                "' is truncated. "
+                                                "Deserialization failed.");
+                }
+                parts[shard].push_back(std::move(item));
+            }
+        });
+
+        objects.clear();
+        for (auto& part : parts)
+        {
+            objects.insert(objects.end(), std::make_move_iterator(part.begin()),
+                           std::make_move_iterator(part.end()));
+        }
+    }
+
+private:
+    ShardManifest shards;                                                       // Манифест.
+};
\ No newline at end of file
@@ -0,0 +1,130 @@
+/*  Класс SharedArchive – архив для одновременной записи записей
+    (объектов) из нескольких потоков выполнения:
+
+        SharedArchive log(1 << 20);
+        // В любом потоке:
+        log.append(record);
+
+    Каждый поток сериализует запись в собственный буфер (без
+    синхронизации с другими потоками), затем резервирует место в общей
+    области атомарной операцией (compare-and-swap, без блокировок)
+    и копирует туда запись. Записи в области следуют друг за другом
+    в порядке резервирования; записанной считается непрерывная начальная
+    часть области (запись становится видимой после всех предыдущих,
+    копирование при этом идет параллельно). Записи читаются обычным
+    архивом:
+
+        std::istringstream input(log.data());
+        Archive<std::istringstream> ia(input);
+        ia >> record;
+
+    Записи сериализуются независимо, поэтому параметры кодирования
+    архива (словарь строк, упаковка ключей и т.п.) не используются.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "serialization.h"
+
+class SharedArchive
+{
+public:
+    explicit SharedArchive(size_t capacity)                                     // Конструктор с размером общей области в байтах.
+        : capacity(capacity), region(new char[capacity]) {}
+
+    SharedArchive(const SharedArchive&) = delete;
+    SharedArchive& operator=(const SharedArchive&) = delete;
+
+    template <typename T>                                                       // Метод для добавления записи t (можно вызывать из разных
+    bool append(T& t)                                                           // потоков одновременно). Возвращает false, если в области
+    {                                                                           // не хватает места (запись не добавляется).
+        std::ostringstream output(std::ios_base::binary);                       // Сериализуем запись в локальный буфер.
+        {
+            Archive<std::ostringstream> archive(output);
+            archive << t;
+        }
+        const std::string record = output.str();
+
+        size_t offset = reserved.load(std::memory_order_relaxed);               // Резервируем место: повторяем, пока другой поток
+        do                                                                      // не перестанет сдвигать границу одновременно с нами.
+        {
+            if (record.size() > capacity - offset)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        while (!reserved.compare_exchange_weak(offset, offset + record.size(),
+                                               std::memory_order_relaxed));
+
+        std::memcpy(region.get() + offset, record.data(), record.size());       // Копируем запись и, когда скопированы все предыдущие
+        while (committed.load(std::memory_order_acquire) != offset)             // записи, сдвигаем границу записанных данных (делает
+        {                                                                       // запись видимой для wait()).
+            std::this_thread::yield();
+        }
+        committed.store(offset + record.size(), std::memory_order_release);
+        records.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t wait() const                                                         // Метод для ожидания завершения копирования записей,
+    {                                                                           // зарезервированных до вызова. Возвращает размер
+        size_t target = reserved.load(std::memory_order_acquire);               // записанных данных (записи, добавляемые одновременно
+        size_t size = committed.load(std::memory_order_acquire);                // с ожиданием, могут войти в него целиком).
+        while (size < target)
+        {
+            std::this_thread::yield();
+            size = committed.load(std::memory_order_acquire);
+        }
+        return size;
+    }
+
+    std::string data() const                                                    // Метод для получения записанных данных (ожидает
+    {                                                                           // завершения копирования записей, добавленных до вызова).
+        return std::string(region.get(), wait());
+    }
+
+    void write(std::ostream& stream) const                                      // Метод для записи данных в поток.
+    {
+        stream.write(region.get(), wait());
+    }
+
+    void clear()                                                                // Метод для очистки области (только когда записи
+    {                                                                           // не добавляются).
+        wait();
+        reserved.store(0);
+        committed.store(0);
+        records.store(0);
+        dropped.store(0);
+    }
+
+    size_t size() const                                                         // Методы для получения количества записанных байт,
+    {                                                                           // добавленных и отброшенных (из-за нехватки места) записей.
+        return committed.load(std::memory_order_acquire);
+    }
+
+    size_t appended_records() const
+    {
+        return records.load(std::memory_order_relaxed);
+    }
+
+    size_t dropped_records() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    const size_t capacity;                                                      // Размер общей области.
+    std::unique_ptr<char[]> region;                                             // Общая область.
+    std::atomic<size_t> reserved{0};                                            // Количество зарезервированных байт.
+    std::atomic<size_t> committed{0};                                           // Количество скопированных байт.
+    std::atomic<size_t> records{0};                                             // Количество добавленных записей.
+    std::atomic<size_t> dropped{0};                                             // Количество отброшенных записей.
+};
\ No newline at end of file
@@ -0,0 +1,227 @@
+/*  Классы SnapshotWriter и SnapshotReader реализуют разностные
+    снимки объекта: сериализованное представление объекта делится
+    на блоки фиксированного размера, и в поток записываются только
+    блоки, изменившиеся с предыдущего снимка (для их поиска писателю
+    достаточно хешей блоков предыдущего снимка). Первый снимок
+    содержит все блоки.
+    Читатель хранит сериализованное представление предыдущего снимка
+    (базу), применяет к нему изменения и десериализует объект из
+    обновленной базы. Снимки должны применяться в порядке записи:
+    каждый снимок содержит хеш базы, к которой он применяется.
+    Вставка или удаление данных в середине объекта сдвигает все
+    последующие блоки, поэтому разностные снимки эффективны для
+    объектов, изменяющихся "на месте" (значения полей и элементов).
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "serialization.h"
+
+inline uint64_t fnv1a_hash(const char* data, size_t size,                       // Функция для вычисления 64-битного хеша FNV-1a.
+                           uint64_t hash = 14695981039346656037ull)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+inline std::vector<uint64_t> chunk_hashes(const std::string& data,              // Функция для вычисления хешей блоков данных.
+                                          size_t chunk_size)
+{
+    std::vector<uint64_t> hashes;
+    for (size_t begin = 0; begin < data.size(); begin += chunk_size)
+    {
+        hashes.push_back(fnv1a_hash(data.data() + begin,
+                                    std::min(chunk_size, data.size() - begin)));
+    }
+    return hashes;
+}
+
+inline uint64_t snapshot_hash(const std::vector<uint64_t>& hashes,              // Функция для вычисления хеша снимка по хешам блоков и
+                              uint64_t size)                                    // размеру данных.
+{
+    uint64_t hash = fnv1a_hash(reinterpret_cast<const char*>(&size),
+                               sizeof(size));
+    return fnv1a_hash(reinterpret_cast<const char*>(hashes.data()),
+                      hashes.size() * sizeof(uint64_t), hash);
+}
+
+struct SnapshotPatch                                                            // Структура разностного снимка (записывается в поток
+{                                                                               // с помощью Archive).
+    uint64_t base_hash = 0;                                                     // Поля: хеш базы (0 – первый снимок);
+    uint32_t size = 0;                                                          // - размер сериализованного объекта;
+    uint32_t chunk_size = 0;                                                    // - размер блока;
+    std::map<uint32_t, std::string> chunks;                                     // - изменившиеся блоки по номерам.
+
+private:
+    friend struct Access;
+
+    template <typename Stream>
+    void serialize(Serializer<Stream> s)
+    {
+        s & base_hash;
+        s & size;
+        s & chunk_size;
+        s & chunks;
+    }
+};
+
+class SnapshotWriter
+{
+public:
+    SnapshotWriter(uint32_t chunk_size = 4096)                                  // Конструктор с размером блока в байтах.
+        : chunk_size(chunk_size)
+    {
+        if (!chunk_size)
+        {
+            throw std::invalid_argument(
+                "Snapshot chunk size must be positive.");
+        }
+    }
+
+    template <typename T>                                                       // Метод для записи снимка объекта t в поток stream: записываются
+    void write(T& t, std::ostream& stream)                                      // только блоки, изменившиеся с предыдущего снимка.
+    {
+        std::ostringstream output(std::ios_base::binary);
+        {
+            Archive<std::ostringstream> archive(output);
+            archive << t;
+        }
+        const std::string data = output.str();
+        if (data.size() > std::numeric_limits<uint32_t>::max())                 // Размер в снимке – 4 байта (проверяем до изменения
+        {                                                                       // состояния писателя).
+            throw std::invalid_argument("Snapshot object size exceeds 2^32 "
+                                        "bytes. Serialization failed.");
+        }
+        std::vector<uint64_t> current = chunk_hashes(data, chunk_size);
+
+        SnapshotPatch patch;
+        patch.base_hash = base_hash;
+        patch.size = static_cast<uint32_t>(data.size());
+        patch.chunk_size = chunk_size;
+
+        for (size_t i = 0; i < current.size(); i++)                             // Блок записывается, если он новый или его хеш изменился
+        {                                                                       // (последний блок изменяется и при изменении размера).
+            if (i >= hashes.size() || hashes[i] != current[i])
+            {
+                size_t begin = i * chunk_size;
+                patch.chunks[static_cast<uint32_t>(i)] =
+                    data.substr(begin, chunk_size);
+            }
+        }
+
+        Archive<std::ostream> archive(stream);
+        archive << patch;
+
+        hashes = std::move(current);
+        base_hash = snapshot_hash(hashes, data.size());
+        changed = patch.chunks.size();
+    }
+
+    size_t changed_chunks() const                                               // Метод для получения количества блоков, записанных
+    {                                                                           // в последний снимок.
+        return changed;
+    }
+
+private:
+    uint32_t chunk_size;                                                        // Размер блока.
+    std::vector<uint64_t> hashes;                                               // Хеши блоков предыдущего снимка.
+    uint64_t base_hash = 0;                                                     // Хеш предыдущего снимка (0 – снимков не было).
+    size_t changed = 0;                                                         // Количество блоков в последнем снимке.
+};
+
+class SnapshotReader
+{
+public:
+    template <typename T>                                                       // Метод для чтения снимка из потока stream: применяет
+    void read(std::istream& stream, T& t)                                       // изменившиеся блоки к базе и десериализует объект t.
+    {                                                                           // При ошибке выбрасывает std::invalid_argument (если
+        SnapshotPatch patch;                                                    // снимок некорректен, база не изменяется).
+        {
+            Archive<std::istream> archive(stream);
+            archive >> patch;
+        }
+
+        apply(patch);
+
+        std::istringstream input(base, std::ios_base::binary);
+        Archive<std::istringstream> archive(input);
+        archive >> t;
+    }
+
+    const std::string& data() const                                             // Метод для получения сериализованного представления
+    {                                                                           // последнего снимка.
+        return base;
+    }
+
+private:
+    void apply(const SnapshotPatch& patch)                                      // Метод для применения разностного снимка к базе.
+    {
+        if (patch.base_hash != base_hash)
+        {
+            throw std::invalid_argument("Snapshot does not match the base "
+                                        "snapshot. Deserialization failed.");
+        }
+
+        if (!patch.chunk_size)
+        {
+            throw std::invalid_argument("Invalid snapshot chunk size. "
+                                        "Deserialization failed.");
+        }
+
+        uint64_t chunk_size = patch.chunk_size;
+        uint64_t chunks = (uint64_t(patch.size) + chunk_size - 1) / chunk_size;
+        uint64_t full = std::min<uint64_t>(base.size(), patch.size) /
+                        chunk_size;
+
+        for (uint64_t i = full; i < chunks; i++)                                // Блок может отсутствовать в снимке, только если он есть
+        {                                                                       // в базе и имеет тот же размер (проверяем до выделения
+            uint64_t begin = i * chunk_size;                                    // памяти; полные блоки, общие для базы и снимка, проверять
+            bool kept = begin < base.size() &&                                  // не нужно).
+                        std::min(chunk_size, base.size() - begin) ==
+                        std::min(chunk_size, patch.size - begin);
+
+            if (!kept && !patch.chunks.count(static_cast<uint32_t>(i)))
+            {
+                throw std::invalid_argument("Snapshot chunk is missing. "
+                                            "Deserialization failed.");
+            }
+        }
+
+        for (const auto& chunk : patch.chunks)
+        {
+            uint64_t begin = chunk.first * chunk_size;
+            if (chunk.first >= chunks ||
+                chunk.second.size() !=
+                    std::min<uint64_t>(chunk_size, patch.size - begin))
+            {
+                throw std::invalid_argument("Invalid snapshot chunk. "
+                                            "Deserialization failed.");
+            }
+        }
+
+        base.resize(patch.size);
+        for (const auto& chunk : patch.chunks)
+        {
+            base.replace(size_t(chunk.first) * patch.chunk_size,
+                         chunk.second.size(), chunk.second);
+        }
+
+        base_hash = snapshot_hash(chunk_hashes(base, patch.chunk_size),
+                                  base.size());
+    }
+
+    std::string base;                                                           // Сериализованное представление последнего снимка.
+    uint64_t base_hash = 0;                                                     // Хеш последнего снимка (0 – снимков не было).
+};
\ No newline at end of file
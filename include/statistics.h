@@ -0,0 +1,225 @@
+/*  Класс Statistics собирает статистику сериализации по каждому типу:
+    количество вызовов, объем записанных/прочитанных данных (в байтах),
+    суммарное время и гистограмму размеров контейнеров.
+    Сбор статистики включается макросом SERIALIZATION_STATISTICS
+    (опция CMake с тем же именем). Без него Serializer и Archive
+    не содержат никакого кода для сбора статистики.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+inline size_t next_type_index()                                                 // Функция для выдачи очередного порядкового номера типа
+{                                                                               // (номера выдаются при первом обращении к типу и служат
+    static std::atomic<size_t> counter(0);                                      // индексами в таблице статистики).
+    return counter++;
+}
+
+template <typename T>                                                           // Порядковый номер типа T: вычисляется один раз при первом
+size_t type_index()                                                             // вызове для каждого типа.
+{
+    static const size_t index = next_type_index();
+    return index;
+}
+
+inline std::string demangle(const char* name)                                   // Функция для получения читаемого имени типа из
+{                                                                               // декорированного имени typeid(T).name() (только GCC/Clang,
+#ifdef __GNUG__                                                                 // для остальных компиляторов имя возвращается как есть).
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+
+    if (status == 0 && demangled)
+    {
+        std::string result(demangled);
+        std::free(demangled);
+        return result;
+    }
+#endif
+    return name;
+}
+
+struct TypeStatistics                                                           // Статистика сериализации одного типа.
+{                                                                               // Поля:
+    static const size_t buckets = 33;                                           // - количество корзин гистограммы (0 и по одной на каждую
+                                                                                //   степень двойки для 32-битных размеров);
+    std::string name;                                                           // - имя типа;
+    uint64_t calls = 0;                                                         // - количество вызовов сериализации;
+    uint64_t bytes = 0;                                                         // - объем записанных/прочитанных данных (вместе с вложенными);
+    uint64_t nanoseconds = 0;                                                   // - суммарное время (вместе с вложенными);
+    std::array<uint64_t, buckets> sizes = {{}};                                 // - гистограмма размеров: корзина i содержит количество
+};                                                                              //   контейнеров размером [2^(i-1), 2^i).
+
+class Statistics
+{
+public:
+    template <typename T>                                                       // Метод для получения статистики типа T (nullptr, если
+    const TypeStatistics* find() const                                          // объекты этого типа не сериализовались).
+    {
+        size_t index = type_index<T>();
+        if (index >= types.size() || types[index].name.empty())
+        {
+            return nullptr;
+        }
+        return &types[index];
+    }
+
+    std::vector<TypeStatistics> collected() const                               // Метод для получения статистики всех сериализованных типов.
+    {
+        std::vector<TypeStatistics> result;
+        for (const auto& type : types)
+        {
+            if (!type.name.empty())
+            {
+                result.push_back(type);
+            }
+        }
+        return result;
+    }
+
+    uint64_t total_bytes() const                                                // Общий объем записанных/прочитанных данных.
+    {
+        return bytes;
+    }
+
+    void reset()                                                                // Метод для сброса накопленной статистики.
+    {
+        types.clear();
+        bytes = 0;
+    }
+
+    void write_json(std::ostream& os) const                                     // Метод для вывода статистики в поток в формате JSON.
+    {
+        os << "{\"total_bytes\": " << bytes << ", \"types\": [";
+        bool first_type = true;
+
+        for (const auto& type : types)
+        {
+            if (type.name.empty())
+            {
+                continue;
+            }
+
+            os << (first_type ? "" : ", ") << "{\"type\": \"";
+            first_type = false;
+
+            for (char c : type.name)                                            // Экранируем кавычки и обратную косую черту в имени типа.
+            {
+                if (c == '"' || c == '\\')
+                {
+                    os << '\\';
+                }
+                os << c;
+            }
+
+            os << "\", \"calls\": " << type.calls
+               << ", \"bytes\": " << type.bytes
+               << ", \"nanoseconds\": " << type.nanoseconds
+               << ", \"sizes\": {";
+
+            bool first_size = true;
+            for (size_t i = 0; i < TypeStatistics::buckets; i++)                // Выводим только непустые корзины гистограммы с нижней
+            {                                                                   // границей размеров в качестве ключа.
+                if (type.sizes[i])
+                {
+                    os << (first_size ? "" : ", ") << '"'
+                       << (i ? uint64_t(1) << (i - 1) : 0) << "\": "
+                       << type.sizes[i];
+                    first_size = false;
+                }
+            }
+            os << "}}";
+        }
+        os << "]}";
+    }
+
+private:
+    template <typename T>
+    friend class StatisticsScope;
+
+    template <typename Stream>
+    friend class Serializer;
+
+    template <typename T>                                                       // Метод для получения (и создания при необходимости)
+    TypeStatistics& get()                                                       // записи статистики типа T.
+    {
+        size_t index = type_index<T>();
+        if (index >= types.size())
+        {
+            types.resize(index + 1);
+        }
+
+        TypeStatistics& type = types[index];
+        if (type.name.empty())
+        {
+            type.name = demangle(typeid(T).name());
+        }
+        return type;
+    }
+
+    template <typename T>                                                       // Метод для учета размера контейнера типа T в гистограмме.
+    void record_size(uint64_t size)
+    {
+        size_t bucket = 0;
+        while (size && bucket < TypeStatistics::buckets - 1)                    // Номер корзины – количество значащих бит размера.
+        {
+            size >>= 1;
+            bucket++;
+        }
+        get<T>().sizes[bucket]++;
+    }
+
+    std::vector<TypeStatistics> types;                                          // Таблица статистики, индексируемая номерами типов.
+    uint64_t bytes = 0;                                                         // Общий объем записанных/прочитанных данных.
+};
+
+template <typename T>                                                           // Класс для учета одного вызова сериализации типа T:
+class StatisticsScope                                                           // запоминает время и объем данных при создании и добавляет
+{                                                                               // разницу в статистику типа при уничтожении (в том числе
+public:                                                                         // при выходе по исключению).
+    StatisticsScope(Statistics* statistics)
+        : statistics(statistics)
+    {
+        if (statistics)
+        {
+            index = type_index<T>();
+            statistics->get<T>();
+            bytes = statistics->bytes;
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    StatisticsScope(const StatisticsScope&) = delete;
+    StatisticsScope& operator=(const StatisticsScope&) = delete;
+
+    ~StatisticsScope()
+    {
+        if (statistics)
+        {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            TypeStatistics& type = statistics->types[index];                    // Обращаемся по индексу, т.к. таблица могла быть
+            type.calls++;                                                       // перераспределена при сериализации вложенных типов.
+            type.bytes += statistics->bytes - bytes;
+            type.nanoseconds += std::chrono::duration_cast<
+                std::chrono::nanoseconds>(elapsed).count();
+        }
+    }
+
+private:
+    Statistics* statistics;                                                     // Статистика архива (nullptr – сбор не ведется).
+    size_t index = 0;                                                           // Порядковый номер типа T.
+    uint64_t bytes = 0;                                                         // Объем данных на момент начала сериализации.
+    std::chrono::steady_clock::time_point start;                                // Время начала сериализации.
+};
\ No newline at end of file
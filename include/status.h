@@ -0,0 +1,50 @@
+/*  Коды ошибок сериализации и состояние ошибок архива.
+    По умолчанию ошибки сериализации приводят к исключениям
+    std::invalid_argument. В режиме кодов ошибок (см.
+    Archive::try_serialize) первая ошибка сохраняется в ErrorState,
+    после чего сериализация прекращается без исключений.
+*/
+
+#pragma once
+
+#include <ostream>
+
+enum class Status                                                               // Перечисление для кодов ошибок сериализации:
+{
+    Ok,                                                                         // - ошибок нет;
+    UnexpectedEnd,                                                              // - данные во входном потоке закончились раньше, чем ожидалось;
+    SizeMismatch,                                                               // - размер статического массива не совпадает с сериализованным;
+    InputTooShort,                                                              // - заявленный размер превышает остаток входного потока;
+    BudgetExceeded,                                                             // - заявленный размер превышает бюджет памяти архива;
+    UnsupportedType,                                                            // - тип не поддерживает сериализацию;
+    InvalidData,                                                                // - некорректные закодированные данные (например, ширина
+                                                                                //   упакованных значений);
+    Exception                                                                   // - исключение, выброшенное вне сериализатора (например,
+};                                                                              //   std::bad_alloc или исключение из метода serialize).
+
+inline const char* to_string(Status status)                                     // Функция для получения описания кода ошибки.
+{
+    switch (status)
+    {
+    case Status::Ok:              return "Ok";
+    case Status::UnexpectedEnd:   return "Unexpected end of input";
+    case Status::SizeMismatch:    return "Different sizes of static std arrays";
+    case Status::InputTooShort:   return "Claimed size exceeds remaining input";
+    case Status::BudgetExceeded:  return "Claimed size exceeds memory budget";
+    case Status::UnsupportedType: return "Unsupported type";
+    case Status::InvalidData:     return "Invalid encoded data";
+    case Status::Exception:       return "Exception";
+    }
+    return "Unknown status";
+}
+
+inline std::ostream& operator<<(std::ostream& os, Status status)                // Оператор вывода кода ошибки в поток.
+{
+    return os << to_string(status);
+}
+
+struct ErrorState                                                               // Состояние ошибок архива.
+{                                                                               // Поля:
+    bool throw_errors = true;                                                   // - признак выбрасывания исключений при ошибках;
+    Status status = Status::Ok;                                                 // - первая ошибка (в режиме кодов ошибок).
+};
\ No newline at end of file
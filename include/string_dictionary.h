@@ -0,0 +1,28 @@
+/*  Структура StringDictionary – словарь строк архива. Если словарь
+    включен (Archive::set_string_dictionary), каждая строка
+    (std::string) записывается с 4-байтной ссылкой: 0 – новая строка,
+    за которой следует сама строка (она получает очередной номер
+    в словаре), иначе – номер ранее записанной строки. Повторяющиеся
+    строки (метки, символы, ключи) записываются один раз, а при
+    десериализации копируются из словаря без повторного чтения.
+    Порядок сериализации объектов должен совпадать при записи и чтении.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct StringDictionary
+{
+    void clear()                                                                // Метод для очистки словаря (например, перед записью или
+    {                                                                           // чтением независимого блока данных).
+        indices.clear();
+        strings.clear();
+    }
+                                                                                // Поля:
+    std::unordered_map<std::string, uint32_t> indices;                          // - номера записанных строк (при сериализации);
+    std::vector<std::string> strings;                                           // - прочитанные строки (при десериализации).
+};
\ No newline at end of file
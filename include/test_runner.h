@@ -8,7 +8,11 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <fstream>
 #include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <vector>
 #include <set>
 #include <map>
 
@@ -35,8 +39,121 @@ public:
         }
     }
     
+    template <class TestFunc>                                                   // Шаблонный метод для запуска одного теста производительности:
+    void RunPerfTest(const TestFunc& func, const std::string& func_name,        // вызывает тестовую функцию perf_iterations раз (после
+                     double median_budget_ns = 0)                               // нескольких "прогревочных" вызовов), вычисляет медиану и
+    {                                                                           // 99-й перцентиль времени выполнения и сравнивает их с
+        try                                                                     // бюджетом median_budget_ns (если задан) и с базовыми
+        {                                                                       // значениями из файла (если задан, см. SetPerfBaseline).
+            for (size_t i = 0; i < perf_warmup; i++)
+            {
+                func();
+            }
+
+            std::vector<double> timings(perf_iterations);                       // Замеряем время каждого вызова в наносекундах.
+            for (auto& timing : timings)
+            {
+                auto start = std::chrono::steady_clock::now();
+                func();
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                timing = std::chrono::duration<double, std::nano>(elapsed).count();
+            }
+
+            double median = Percentile(timings, 0.5);
+            double p99 = Percentile(timings, 0.99);
+
+            std::ostringstream os;
+            os << std::fixed;
+            os.precision(0);
+            os << "median " << median << " ns, p99 " << p99 << " ns";
+
+            if (median_budget_ns > 0 && median > median_budget_ns)              // Проверяем явно заданный бюджет.
+            {
+                os << ". Median exceeds budget " << median_budget_ns << " ns";
+                throw std::runtime_error(os.str());
+            }
+
+            auto baseline = perf_baselines.find(func_name);
+            if (baseline == perf_baselines.end() || perf_update)                // Если базовых значений нет (или требуется их обновление),
+            {                                                                   // запоминаем текущие.
+                if (!perf_baseline_file.empty())
+                {
+                    perf_baselines[func_name] = { median, p99 };
+                    perf_baselines_changed = true;
+                }
+            }
+            else                                                                // Иначе сравниваем с базовыми значениями с учетом
+            {                                                                   // допустимого превышения perf_margin (perf_p99_margin
+                if (median > baseline->second.first * (1.0 + perf_margin) ||    // для 99-го перцентиля, который сильнее подвержен шуму).
+                    p99 > baseline->second.second * (1.0 + perf_p99_margin))
+                {
+                    os << ". Baseline (median " << baseline->second.first
+                       << " ns, p99 " << baseline->second.second
+                       << " ns) exceeded by more than "
+                       << perf_margin * 100 << "% (median) or "
+                       << perf_p99_margin * 100 << "% (p99)";
+                    throw std::runtime_error(os.str());
+                }
+            }
+
+            std::cerr << func_name << " OK (" << os.str() << ')' << std::endl;
+        }
+        catch(std::exception& e)
+        {
+            std::cerr << func_name << " failed. " << e.what() << std::endl;
+            ++fail_count;
+        }
+        catch(...)
+        {
+            std::cerr << "Unknown exception caught" << std::endl;
+            ++fail_count;
+        }
+    }
+
+    void SetPerfBaseline(const std::string& file_name,                          // Метод для задания файла с базовыми значениями времени
+                         double margin = 1.0, double p99_margin = 4.0)          // (строки вида "имя медиана p99") и допустимого превышения
+    {                                                                           // медианы и p99 (1.0 – не более чем вдвое). Отсутствующие
+        perf_baseline_file = file_name;                                         // в файле тесты дописываются в него при уничтожении
+        perf_margin = margin;                                                   // TestRunner.
+        perf_p99_margin = p99_margin;
+        perf_baselines.clear();
+
+        std::ifstream input(file_name);
+        std::string name;
+        double median = 0, p99 = 0;
+
+        while (input >> name >> median >> p99)
+        {
+            perf_baselines[name] = { median, p99 };
+        }
+    }
+
+    void SetPerfIterations(size_t iterations, size_t warmup = 3)                // Метод для задания количества замеров и "прогревочных"
+    {                                                                           // вызовов тестов производительности.
+        perf_iterations = std::max<size_t>(iterations, 1);
+        perf_warmup = warmup;
+    }
+
+    void SetPerfUpdate(bool update)                                             // Метод для перезаписи базовых значений текущими замерами
+    {                                                                           // (например, после намеренного изменения производительности).
+        perf_update = update;
+    }
+
     ~TestRunner()                                                               // Деструктор (предполагается, что он будет вызываться перед
     {                                                                           // началом выполнения основного кода программы).
+        if (perf_baselines_changed)                                             // Сохраняем новые базовые значения времени.
+        {
+            std::ofstream output(perf_baseline_file);
+            output << std::fixed;
+            output.precision(0);
+
+            for (const auto& baseline : perf_baselines)
+            {
+                output << baseline.first << ' ' << baseline.second.first
+                       << ' ' << baseline.second.second << '\n';
+            }
+        }
+
         if (fail_count)                                                         // Если хотя бы один юнит-тест выполнился неудачно,
         {                                                           
             std::cerr << fail_count << " unit-tests failed."                    // Выводим отладочное сообщение в поток ошибок
@@ -47,9 +164,34 @@ public:
     };
     
 private:
+    static double Percentile(std::vector<double> values, double fraction)       // Функция для вычисления перцентиля выборки.
+    {
+        size_t index = static_cast<size_t>(fraction * (values.size() - 1) + 0.5);
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
     int fail_count = 0;                                                         // Счетчик неудачных юнит-тестов.
+                                                                                // Параметры тестов производительности:
+    size_t perf_iterations = 100;                                               // - количество замеров;
+    size_t perf_warmup = 3;                                                     // - количество "прогревочных" вызовов;
+    double perf_margin = 1.0;                                                   // - допустимое превышение базовой медианы;
+    double perf_p99_margin = 4.0;                                               // - допустимое превышение базового p99;
+    bool perf_update = false;                                                   // - признак перезаписи базовых значений;
+    bool perf_baselines_changed = false;                                        // - признак изменения базовых значений;
+    std::string perf_baseline_file;                                             // - файл с базовыми значениями;
+    std::map<std::string, std::pair<double, double>> perf_baselines;            // - базовые значения (медиана и p99) по именам тестов.
 };
 
+template <typename T>                                                           // Предварительные объявления операторов вывода в поток
+typename std::enable_if<is_iterable<T>::value &&                                // (определены ниже): без них шаблоны AssertEqual и сами
+                        std::is_class<T>::value &&                              // операторы не находят перегрузки для стандартных контейнеров
+                        !is_std_string<T>::value,                               // и пар при инстанцировании (ADL ищет только в пространстве
+                        std::ostream&>::type                                    // имен std).
+operator<<(std::ostream& os, const T& t);
+
+template <typename First, typename Second>
+std::ostream& operator<<(std::ostream& os, const std::pair<First, Second>& p);
 
 template <typename X, typename Y>                                               // Шаблонная функция для проверки переменных на равенство:
 void AssertEqual(const X& x, const Y& y, const std::string& hint = {})          // принимает сравниваемые переменные и строку с описанием.
@@ -176,4 +318,14 @@ std::ostream& operator<<(std::ostream& os, const std::pair<First, Second>& p)
 {                                           \
     tr.RunTest(func, #func);                \
 }
-    
+
+/*  Макрос RUN_PERF_TEST(tr, func) вызывает метод
+    RunPerfTest у объекта tr и передает в качестве
+    параметров функцию func и строку с ее названием.
+*/
+
+#define RUN_PERF_TEST(tr, func)             \
+{                                           \
+    tr.RunPerfTest(func, #func);            \
+}
+    
\ No newline at end of file
@@ -1,7 +1,8 @@
 /*  Заголовочный файл с объявлениями тестовых классов и функций,
     используемых для юнит-тестирования.
     Функция TestAll() должна вызываться до начала работы
-    основного кода программы в функции main().
+    основного кода программы в функции main(); тесты
+    производительности (PerfAll()) запускаются отдельно.
 */
 
 #pragma once
@@ -204,6 +205,9 @@ private:
     std::forward_list<double> f = { 0.0, 0.0 };
 };
 
+template <>                                                                     // контейнеры StructWithBasicTypesAndContainers сериализуются
+struct columnar<StructWithBasicTypesAndContainers> : std::true_type {};         // по колонкам
+
 class ClassWithNestedStruct                                                     // тестовый класс с вложенной пользовательской структурой
 {
 public:
@@ -286,6 +290,27 @@ private:
     }
 };
 
+template <>                                                                     // состав полей PodClass::serialize: размер сериализованного
+struct fixed_layout<PodClass>                                                   // представления известен на этапе компиляции
+    : FixedLayout<int, char, uint32_t, int64_t> {};
+
+template <typename Layout>                                                      // тестовая структура, объявленный состав полей которой
+struct MisdeclaredLayout                                                        // (Layout) не совпадает с методом serialize
+{
+    int32_t a = 1;
+    int32_t b = 2;
+
+    template <typename Stream>
+    void serialize(Serializer<Stream> s)
+    {
+        s & a;
+        s & b;
+    }
+};
+
+template <typename Layout>
+struct fixed_layout<MisdeclaredLayout<Layout>> : Layout {};
+
 class BaseClass
 {
 public:
@@ -361,6 +386,139 @@ private:
     std::vector<int> b = { 0, 0, 0 }; 
 };
 
+template <>                                                                     // контейнеры DerivedClass сериализуются по колонкам (поля
+struct columnar<DerivedClass> : std::true_type {};                              // базового класса – в отдельных колонках)
+
+struct GraphNode                                                                // тестовая структура узла графа с указателями на следующий
+{                                                                               // узел и на (возможно, общие с другими узлами) данные
+    int value = 0;
+    Pointer<GraphNode> next;
+    Pointer<std::vector<int>> data;
+
+    template <typename Stream>
+    void serialize(Serializer<Stream> s)
+    {
+        s & value;
+        s & next;
+        s & data;
+    }
+};
+
+struct Message                                                                  // тестовая базовая структура полиморфных сообщений
+{
+    virtual ~Message() = default;
+
+    int id = 0;
+};
+
+struct TextMessage : Message                                                    // тестовые наследники Message
+{
+    TextMessage(int id, std::string text) : text(text)
+    {
+        this->id = id;
+    }
+
+    TextMessage() = default;
+
+    template <typename Stream>
+    void serialize(Serializer<Stream> s)
+    {
+        s & id;
+        s & text;
+    }
+
+    std::string text;
+};
+
+struct ValueMessage : Message
+{
+    ValueMessage(int id, std::vector<double> values) : values(values)
+    {
+        this->id = id;
+    }
+
+    ValueMessage() = default;
+
+    template <typename Stream>
+    void serialize(Serializer<Stream> s)
+    {
+        s & id;
+        s & values;
+    }
+
+    std::vector<double> values;
+};
+
+struct UrgentTextMessage : TextMessage                                          // тестовый наследник TextMessage, отсутствующий в списке
+{                                                                               // наследников Message
+    UrgentTextMessage(int id, std::string text) : TextMessage(id, text) {}
+};
+
+template <>                                                                     // наследники Message, сериализуемые через
+struct polymorphic_types<Message>                                               // Polymorphic<Message>
+    : PolymorphicTypes<Message, TextMessage, ValueMessage> {};
+
+template <bool Coalesced>                                                       // тестовая структура с подряд идущими фундаментальными
+struct SensorSample                                                             // полями: при Coalesced = true поля сериализуются одним
+{                                                                               // вызовом s(...), иначе – оператором & по одному
+    int32_t id = 0;
+    char kind = 0;
+    double x = 0;
+    double y = 0;
+    std::string name;
+    uint16_t flags = 0;
+    int64_t time = 0;
+
+    bool operator==(const SensorSample& other) const
+    {
+        return id == other.id && kind == other.kind && x == other.x &&
+               y == other.y && name == other.name && flags == other.flags &&
+               time == other.time;
+    }
+
+    template <typename Stream>
+    void serialize(Serializer<Stream> s)
+    {
+        serialize_fields(s, std::integral_constant<bool, Coalesced>());
+    }
+
+    template <typename Stream>
+    void serialize_fields(Serializer<Stream>& s, std::true_type)
+    {
+        s(id, kind, x, y, name, flags, time);
+    }
+
+    template <typename Stream>
+    void serialize_fields(Serializer<Stream>& s, std::false_type)
+    {
+        s & id;
+        s & kind;
+        s & x;
+        s & y;
+        s & name;
+        s & flags;
+        s & time;
+    }
+};
+
+struct ColumnarSensorSample : SensorSample<true> {};                            // тестовая структура для поколоночной сериализации полей,
+
+template <>                                                                     // переданных s(...)
+struct columnar<ColumnarSensorSample> : std::true_type {};
+
+struct Quote                                                                    // тестовая структура сообщения с общей для многих сообщений
+{                                                                               // справочной таблицей
+    int id = 0;
+    Memoized<std::map<int, std::string>> table;
+
+    template <typename Stream>
+    void serialize(Serializer<Stream> s)
+    {
+        s & id;
+        s & table;
+    }
+};
+
 /*  Тестовые функции для проверки корректности сериализации.
     Все функции определены в tests.cpp.
     Каждая из этих функций выбрасывает исключение, 
@@ -394,4 +552,128 @@ void TestClassWithNestedStruct();
 
 void TestDerivedClass();                                                        // функция для проверки сериализации класса-наследника
 
-void TestAll();                                                                 // функция для запуска всех тестовых функций
\ No newline at end of file
+void TestBoundedDecoding();                                                     // функция для проверки ограничений памяти при десериализации
+
+void TestErrorCodes();                                                          // функция для проверки режима кодов ошибок
+
+void TestFixedLayout();                                                         // функция для проверки сериализации объектов фиксированного размера
+
+void TestColumnar();                                                            // функция для проверки поколоночной сериализации контейнеров
+
+void TestPackedKeys();                                                          // функция для проверки упаковки целочисленных ключей
+
+void TestStringDictionary();                                                    // функция для проверки словаря строк архива
+
+void TestCompressedFloats();                                                    // функция для проверки сжатия чисел с плавающей точкой
+
+void TestDeltaSnapshots();                                                      // функция для проверки разностных снимков
+
+void TestFileStreams();                                                         // функция для проверки файловых приемника и источника
+
+void TestGatherSink();                                                          // функция для проверки записи без копирования массивов
+
+void TestSharedArchive();                                                       // функция для проверки записи в архив из нескольких потоков
+
+void TestParallelScanner();                                                     // функция для проверки параллельной обработки файла записей
+
+void TestLazySequence();                                                        // функция для проверки ленивого чтения контейнеров
+
+void TestSharedPointers();                                                      // функция для проверки сериализации разделяемых объектов
+
+void TestPolymorphic();                                                         // функция для проверки сериализации через базовый класс
+
+void TestCoalescedFields();                                                     // функция для проверки объединения фундаментальных полей
+
+void TestHashingSink();                                                         // функция для проверки хеширования при сериализации
+
+void TestEncodingCache();                                                       // функция для проверки кэша кодирования вложенных объектов
+
+void TestShardedArchive();                                                      // функция для проверки архива из нескольких файлов
+
+void TestFlatContainers();                                                      // функция для проверки FlatSet и FlatMap
+
+void TestBitContainers();                                                       // функция для проверки упаковки std::vector<bool> и std::bitset
+
+void TestBlobLayout();                                                          // функция для проверки раскладки «смещения и блок данных»
+
+void TestUnsizedRanges();                                                       // функция для проверки записи последовательностей без размера
+
+#ifdef SERIALIZATION_STATISTICS
+void TestStatistics();                                                          // функция для проверки сбора статистики сериализации
+#endif
+
+/*  Функции для проверки производительности
+    (запускаются с помощью RUN_PERF_TEST).
+*/
+
+void PerfMapDecode();                                                           // функция для замера десериализации std::map
+
+void PerfPodVectorEncode();                                                     // функция для замера сериализации вектора классов
+
+void PerfGarbageFramesThrow();                                                  // функции для сравнения десериализации поврежденных данных
+                                                                                // с исключениями и в режиме кодов ошибок
+void PerfGarbageFramesStatus();                                                 //
+
+void PerfPlainSetDecode();                                                      // функции для сравнения десериализации множества без
+                                                                                // упаковки и с упакованными ключами
+void PerfPackedSetDecode();                                                     //
+void PerfFloatSeriesDecodeRaw();                                                // функции для сравнения десериализации временного ряда
+                                                                                // без сжатия и со сжатием XOR
+void PerfFloatSeriesDecodeXor();                                                //
+
+void PerfOfstreamEncode();                                                      // функции для сравнения сериализации в файл и
+                                                                                // десериализации из файла через стандартные потоки
+void PerfFileSinkEncode();                                                      // и через FileSink/FileSource
+
+void PerfIfstreamDecode();                                                      //
+
+void PerfFileSourceDecode();                                                    //
+
+void PerfRecordScanSingleThread();                                              // функции для сравнения обработки файла записей в одном
+                                                                                // потоке и в нескольких потоках
+void PerfRecordScanParallel();                                                  //
+
+void PerfPolymorphicEncode();                                                   // функции для замера сериализации и десериализации
+                                                                                // полиморфных объектов через базовый класс
+void PerfPolymorphicDecode();                                                   //
+
+void PerfSeparateFieldsEncode();                                                // функции для сравнения сериализации фундаментальных полей
+                                                                                // по одному и одной операцией
+void PerfCoalescedFieldsEncode();                                               //
+
+void PerfEncodeThenHash();                                                      // функции для сравнения хеширования после сериализации
+                                                                                // в буфер и во время сериализации
+void PerfHashingSinkEncode();                                                   //
+
+void PerfQuotesEncode();                                                        // функции для сравнения сериализации сообщений с общей
+                                                                                // таблицей без кэша кодирования и с ним
+void PerfQuotesEncodeCached();                                                  //
+
+void PerfShardedWriteSingle();                                                  // функции для сравнения записи снимка в один файл
+                                                                                // и в несколько файлов параллельно
+void PerfShardedWriteParallel();                                                //
+
+void PerfFlatMapDecode();                                                       // функция для замера десериализации FlatMap (ср. PerfMapDecode)
+
+void PerfMapLookup();                                                           // функции для сравнения поиска в std::map и FlatMap
+                                                                                //
+void PerfFlatMapLookup();                                                       //
+
+void PerfBitVectorEncode();                                                     // функции для замера сериализации и десериализации
+                                                                                // упакованного вектора bool
+void PerfBitVectorDecode();                                                     //
+
+void PerfTokensDecode();                                                        // функции для сравнения десериализации вектора строк
+                                                                                // поэлементно, в раскладке «смещения и блок данных» и
+void PerfTokensDecodeBlob();                                                    // в BlobSequence
+
+void PerfTokensDecodeBlobSequence();                                            //
+
+void PerfForwardListEncode();                                                   // функции для замера сериализации односвязного списка и
+                                                                                // последовательности, которую возвращает функция
+void PerfGeneratedEncode();                                                     //
+
+void TestAll();                                                                 // функция для запуска всех тестовых функций
+
+void PerfAll();                                                                 // функция для запуска всех тестов производительности
+                                                                                // (запускается только по флагу --perf, см. main.cpp)
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <type_traits>
 #include <array>
+#include <bitset>
 #include <vector>
 #include <string>
 #include <deque>
@@ -9,6 +10,7 @@
 #include <forward_list>
 #include <set>
 #include <map>
+#include <utility>
 
 template<bool B, class T = void>
 using enable_if_t = typename std::enable_if<B, T>::type;
@@ -68,11 +70,14 @@ using has_insert = decltype(HasInsert::has_insert<T>(0));
 
 // Проверки потоков
 
+template <typename T>                                                           // Проверки оформлены структурами (а не псевдонимами), чтобы
+struct is_ostream : std::is_base_of<std::ostream, T> {};                        // их можно было специализировать для буферов, которые
+                                                                                // используются вместо потоков (см. fixed_layout.h).
 template <typename T>
-using is_ostream = std::is_base_of<std::ostream, T>;
+struct is_istream : std::is_base_of<std::istream, T> {};
 
-template <typename T>
-using is_istream = std::is_base_of<std::istream, T>;
+template <typename T>                                                           // Проверка на выходной поток, принимающий большие
+struct is_gather_ostream : std::false_type {};                                  // непрерывные массивы по ссылке (см. gather_stream.h).
 
 // Проверки стандартных линейных (последовательных) контейнеров
 
@@ -121,3 +126,49 @@ struct is_std_forward_list : public std::false_type {};
 
 template <typename T>
 struct is_std_forward_list<std::forward_list<T>> : public std::true_type {};
+
+// Проверки битовых контейнеров
+
+template <typename>                                                             // Вектор bool (элементы хранятся битами и доступны через
+struct is_bit_vector : public std::false_type {};                               // прокси-ссылки, а не bool&).
+
+template <typename Allocator>
+struct is_bit_vector<std::vector<bool, Allocator>> : public std::true_type {};
+
+template <typename>
+struct is_std_bitset : public std::false_type {};
+
+template <size_t N>
+struct is_std_bitset<std::bitset<N>> : public std::true_type {};
+
+// Проверка на ассоциативный контейнер на основе упорядоченного вектора
+
+template <typename T>                                                           // FlatSet и FlatMap (см. flat_containers.h).
+struct is_flat_container : std::false_type {};
+
+// Размер серии арифметических типов
+
+template <typename... T>                                                        // Суммарный размер подряд идущих арифметических типов
+struct fundamental_run : std::integral_constant<size_t, 0> {};                  // в начале списка T (0 – первый тип не арифметический).
+
+template <typename T, typename... Rest>
+struct fundamental_run<T, Rest...>
+    : std::integral_constant<size_t, std::is_arithmetic<T>::value ?
+        sizeof(T) + fundamental_run<Rest...>::value : 0> {};
+
+// Проверка на контейнер с непрерывным массивом фундаментальных значений
+
+template <typename T>                                                           // Вектор (кроме std::vector<bool>) или строка.
+struct is_contiguous_arithmetic
+    : std::integral_constant<bool,
+        (is_std_vector<T>::value || is_std_string<T>::value) &&
+        std::is_arithmetic<typename T::value_type>::value &&
+        !std::is_same<typename T::value_type, bool>::value> {};
+
+// Проверка на стандартную пару
+
+template <typename>
+struct is_std_pair : public std::false_type {};
+
+template <typename First, typename Second>
+struct is_std_pair<std::pair<First, Second>> : public std::true_type {};
\ No newline at end of file
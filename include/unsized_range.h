@@ -0,0 +1,195 @@
+/*  Сериализация последовательностей, размер которых заранее неизвестен,
+    за один проход: место под размер резервируется, элементы
+    записываются по мере перебора, после чего размер дописывается на
+    зарезервированное место. Формат данных не меняется: такие
+    последовательности читаются в обычные контейнеры (вектор, дек,
+    список).
+    Шаблон класса UnsizedRange<Iterator> – диапазон входных итераторов
+    (например, std::istream_iterator), шаблон класса GeneratedRange –
+    последовательность, элементы которой по одному возвращает функция:
+
+        oa << unsized_range(std::istream_iterator<int>(input),
+                            std::istream_iterator<int>());
+
+        int i = 0;
+        oa << generated<int>([&](int& item) { item = i++; return i <= 10; });
+
+    Такие последовательности можно записывать только в потоки, в которых
+    можно перезаписать уже записанные данные: стандартные потоки,
+    поддерживающие позиционирование (std::ostringstream, std::ofstream),
+    и буферы в памяти. Односвязные списки записываются за один проход
+    (без предварительного подсчета элементов) в потоки в памяти, где
+    перезапись не требует обращений к файлу.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <utility>
+
+#include "traits.h"
+#include "columnar.h"
+
+template <typename T>                                                           // Проверка на выходной поток, в котором можно перезаписать
+struct is_seekable_ostream : std::is_base_of<std::ostream, T> {};               // записанные данные (у стандартных потоков возможность
+                                                                                // позиционирования проверяется при записи).
+template <typename T>                                                           // Проверка на выходной поток в памяти (перезапись данных
+struct is_memory_ostream                                                        // дешевая).
+    : std::integral_constant<bool,
+        std::is_base_of<std::ostringstream, T>::value ||
+        std::is_base_of<std::stringstream, T>::value> {};
+
+template <>
+struct is_seekable_ostream<ColumnOutputBuffer> : std::true_type {};
+
+template <>
+struct is_memory_ostream<ColumnOutputBuffer> : std::true_type {};
+
+inline int64_t output_position(std::ostream& stream)                            // Функции для получения текущей позиции записи (-1, если
+{                                                                               // поток не поддерживает позиционирование)
+    return static_cast<int64_t>(stream.tellp());
+}
+
+inline int64_t output_position(ColumnOutputBuffer& buffer)
+{
+    return static_cast<int64_t>(buffer.data.size());
+}
+
+inline void patch_output(std::ostream& stream, int64_t position,                // и для перезаписи size байт, записанных с позиции
+                         const char* data, size_t size)                         // position (позиция записи не меняется).
+{
+    auto end = stream.tellp();
+    stream.seekp(position);
+    stream.write(data, size);
+    stream.seekp(end);
+}
+
+inline void patch_output(ColumnOutputBuffer& buffer, int64_t position,
+                         const char* data, size_t size)
+{
+    std::memcpy(&buffer.data[position], data, size);
+}
+
+template <typename Iterator>
+class UnsizedRange                                                              // Диапазон итераторов [first, last) без размера.
+{
+public:
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+    UnsizedRange(Iterator first, Iterator last)
+        : first(std::move(first)), last(std::move(last)) {}
+
+    Iterator begin() const
+    {
+        return first;
+    }
+
+    Iterator end() const
+    {
+        return last;
+    }
+
+private:
+    Iterator first;
+    Iterator last;
+};
+
+template <typename Iterator>                                                    // Функция для создания диапазона.
+UnsizedRange<Iterator> unsized_range(Iterator first, Iterator last)
+{
+    return UnsizedRange<Iterator>(std::move(first), std::move(last));
+}
+
+template <typename Item, typename Next>
+class GeneratedRange                                                            // Последовательность элементов, которые возвращает функция
+{                                                                               // next(Item&): функция заполняет элемент и возвращает false,
+public:                                                                         // если элементы закончились. Перебирается один раз.
+    using value_type = Item;
+
+    class iterator                                                              // Входной итератор последовательности.
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Item;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Item*;
+        using reference = Item&;
+
+        explicit iterator(GeneratedRange* range = nullptr) : range(range)
+        {
+            advance();
+        }
+
+        Item& operator*() const
+        {
+            return range->item;
+        }
+
+        Item* operator->() const
+        {
+            return &range->item;
+        }
+
+        iterator& operator++()
+        {
+            advance();
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const
+        {
+            return range == other.range;
+        }
+
+        bool operator!=(const iterator& other) const
+        {
+            return range != other.range;
+        }
+
+    private:
+        void advance()                                                          // Метод для получения следующего элемента (после
+        {                                                                       // последнего итератор становится конечным).
+            if (range && !range->next(range->item))
+            {
+                range = nullptr;
+            }
+        }
+
+        GeneratedRange* range;
+    };
+
+    explicit GeneratedRange(Next next) : next(std::move(next)) {}
+
+    iterator begin()
+    {
+        return iterator(this);
+    }
+
+    iterator end()
+    {
+        return iterator();
+    }
+
+private:
+    Next next;                                                                  // Функция для получения элементов.
+    Item item;                                                                  // Текущий элемент.
+};
+
+template <typename Item, typename Next>                                         // Функция для создания последовательности.
+GeneratedRange<Item, Next> generated(Next next)
+{
+    return GeneratedRange<Item, Next>(std::move(next));
+}
+
+template <typename>
+struct is_unsized_range : std::false_type {};
+
+template <typename Iterator>
+struct is_unsized_range<UnsizedRange<Iterator>> : std::true_type {};
+
+template <typename Item, typename Next>
+struct is_unsized_range<GeneratedRange<Item, Next>> : std::true_type {};
@@ -0,0 +1,63 @@
+/*  Класс WorkerThreads – группа рабочих потоков выполнения, которые
+    дожидаются в деструкторе, в том числе при исключении (например, если
+    не удалось запустить очередной поток: уничтожение std::thread, с
+    которым еще не соединились, завершает программу):
+
+        std::atomic<bool> stop(false);
+        {
+            WorkerThreads workers(&stop);
+            for (size_t i = 1; i < count; i++)
+            {
+                workers.start(worker, i);
+            }
+            worker(0);
+        }
+
+    Перед ожиданием устанавливается флаг остановки (если он задан), чтобы
+    потоки не брали новую работу.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class WorkerThreads
+{
+public:
+    explicit WorkerThreads(std::atomic<bool>* stop = nullptr) : stop(stop) {}   // Конструктор с необязательным флагом остановки.
+
+    WorkerThreads(const WorkerThreads&) = delete;
+    WorkerThreads& operator=(const WorkerThreads&) = delete;
+
+    ~WorkerThreads()
+    {
+        join();
+    }
+
+    template <typename Function, typename... Args>                              // Метод для запуска потока function(args...).
+    void start(Function&& function, Args&&... args)
+    {
+        threads.emplace_back(std::forward<Function>(function),
+                             std::forward<Args>(args)...);
+    }
+
+    void join()                                                                 // Метод для установки флага остановки и ожидания
+    {                                                                           // завершения всех потоков.
+        if (stop)
+        {
+            *stop = true;
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        threads.clear();
+    }
+
+private:
+    std::atomic<bool>* stop;                                                    // Флаг остановки.
+    std::vector<std::thread> threads;                                           // Потоки.
+};
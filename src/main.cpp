@@ -1,8 +1,18 @@
 #include "tests.h"
 
+#include <cstring>
+
 int main(int argc, char const *argv[])
 {
     TestAll();
 
+    for (int i = 1; i < argc; i++)                                              // Тесты производительности зависят от машины и
+    {                                                                           // перезаписывают perf_baseline.txt в текущем каталоге,
+        if (std::strcmp(argv[i], "--perf") == 0)                                // поэтому запускаются только по явному флагу.
+        {
+            PerfAll();
+        }
+    }
+
     return 0;
 }
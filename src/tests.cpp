@@ -6,8 +6,21 @@
 #include "tests.h"
 #include "test_runner.h"
 #include "serialization.h"
-
+#include "snapshot.h"
+#include "file_stream.h"
+#include "gather_stream.h"
+#include "shared_archive.h"
+#include "record_scanner.h"
+#include "hashing_sink.h"
+#include "sharded_archive.h"
+
+#include <chrono>
+#include <cstdio>
 #include <fstream>
+#include <iterator>
+#include <random>
+#include <thread>
+#include <atomic>
 
 using namespace std;
 
@@ -35,6 +48,72 @@ void TestAll()
     RUN_TEST(tr, TestSerializeAccessCombinations);                              //
     RUN_TEST(tr, TestClassWithNestedStruct);                                    //
     RUN_TEST(tr, TestDerivedClass);                                             //
+    RUN_TEST(tr, TestBoundedDecoding);                                          //
+    RUN_TEST(tr, TestErrorCodes);                                               //
+    RUN_TEST(tr, TestFixedLayout);                                              //
+    RUN_TEST(tr, TestColumnar);                                                 //
+    RUN_TEST(tr, TestPackedKeys);                                               //
+    RUN_TEST(tr, TestStringDictionary);                                         //
+    RUN_TEST(tr, TestCompressedFloats);                                         //
+    RUN_TEST(tr, TestDeltaSnapshots);                                           //
+    RUN_TEST(tr, TestFileStreams);                                              //
+    RUN_TEST(tr, TestGatherSink);                                               //
+    RUN_TEST(tr, TestSharedArchive);                                            //
+    RUN_TEST(tr, TestParallelScanner);                                          //
+    RUN_TEST(tr, TestLazySequence);                                             //
+    RUN_TEST(tr, TestSharedPointers);                                           //
+    RUN_TEST(tr, TestPolymorphic);                                              //
+    RUN_TEST(tr, TestCoalescedFields);                                          //
+    RUN_TEST(tr, TestHashingSink);                                              //
+    RUN_TEST(tr, TestEncodingCache);                                            //
+    RUN_TEST(tr, TestShardedArchive);                                           //
+    RUN_TEST(tr, TestFlatContainers);                                           //
+    RUN_TEST(tr, TestBitContainers);                                            //
+    RUN_TEST(tr, TestBlobLayout);                                               //
+    RUN_TEST(tr, TestUnsizedRanges);                                            //
+#ifdef SERIALIZATION_STATISTICS
+    RUN_TEST(tr, TestStatistics);                                               //
+#endif
+}
+
+void PerfAll()                                                                  // Функция для запуска тестов производительности:
+{
+    TestRunner tr;
+    tr.SetPerfBaseline("perf_baseline.txt");                                    // Тесты производительности сравниваются с базовыми
+    RUN_PERF_TEST(tr, PerfMapDecode);                                           // значениями из файла perf_baseline.txt (создается при
+    RUN_PERF_TEST(tr, PerfPodVectorEncode);                                     // первом запуске).
+    RUN_PERF_TEST(tr, PerfGarbageFramesThrow);                                  //
+    RUN_PERF_TEST(tr, PerfGarbageFramesStatus);                                 //
+    RUN_PERF_TEST(tr, PerfPlainSetDecode);                                      //
+    RUN_PERF_TEST(tr, PerfPackedSetDecode);                                     //
+    RUN_PERF_TEST(tr, PerfFloatSeriesDecodeRaw);                                //
+    RUN_PERF_TEST(tr, PerfFloatSeriesDecodeXor);                                //
+    RUN_PERF_TEST(tr, PerfOfstreamEncode);                                      //
+    RUN_PERF_TEST(tr, PerfFileSinkEncode);                                      //
+    RUN_PERF_TEST(tr, PerfIfstreamDecode);                                      //
+    RUN_PERF_TEST(tr, PerfFileSourceDecode);                                    //
+    RUN_PERF_TEST(tr, PerfRecordScanSingleThread);                              //
+    RUN_PERF_TEST(tr, PerfRecordScanParallel);                                  //
+    RUN_PERF_TEST(tr, PerfPolymorphicEncode);                                   //
+    RUN_PERF_TEST(tr, PerfPolymorphicDecode);                                   //
+    RUN_PERF_TEST(tr, PerfSeparateFieldsEncode);                                //
+    RUN_PERF_TEST(tr, PerfCoalescedFieldsEncode);                               //
+    RUN_PERF_TEST(tr, PerfEncodeThenHash);                                      //
+    RUN_PERF_TEST(tr, PerfHashingSinkEncode);                                   //
+    RUN_PERF_TEST(tr, PerfQuotesEncode);                                        //
+    RUN_PERF_TEST(tr, PerfQuotesEncodeCached);                                  //
+    RUN_PERF_TEST(tr, PerfShardedWriteSingle);                                  //
+    RUN_PERF_TEST(tr, PerfShardedWriteParallel);                                //
+    RUN_PERF_TEST(tr, PerfFlatMapDecode);                                       //
+    RUN_PERF_TEST(tr, PerfMapLookup);                                           //
+    RUN_PERF_TEST(tr, PerfFlatMapLookup);                                       //
+    RUN_PERF_TEST(tr, PerfBitVectorEncode);                                     //
+    RUN_PERF_TEST(tr, PerfBitVectorDecode);                                     //
+    RUN_PERF_TEST(tr, PerfTokensDecode);                                        //
+    RUN_PERF_TEST(tr, PerfTokensDecodeBlob);                                    //
+    RUN_PERF_TEST(tr, PerfTokensDecodeBlobSequence);                            //
+    RUN_PERF_TEST(tr, PerfForwardListEncode);                                   //
+    RUN_PERF_TEST(tr, PerfGeneratedEncode);                                     //
 }
 
 template <typename T, typename Stream>                                          // Шаблонная функция, выполняющая попытку сериализации 
@@ -788,4 +867,2612 @@ void TestDerivedClass()
         ASSERT_EQUAL(new_derived_a, derived_a);
         ASSERT_FALSE(fail_counter);
     }
-}
\ No newline at end of file
+}
+
+void TestBoundedDecoding()                                                      // поврежденные размеры контейнеров и бюджет памяти
+{
+    vector<int> a(1000, 7);
+    uint32_t corrupt_size = 0xFFFFFFF0;                                         // Размер, которому не соответствуют данные в потоке.
+    bool not_null = false;
+    size_t corrupt_pointer_size = size_t(1) << 60;
+
+    size_t fail_counter = 0;
+
+    {
+        CREATE_TEST_OUTPUT_ARCHIVE(oa);
+
+        SerializeAndCountFails(a, oa, fail_counter);
+        SerializeAndCountFails(a, oa, fail_counter);
+        SerializeAndCountFails(corrupt_size, oa, fail_counter);                 // vector<double>
+    }
+
+    {
+        CREATE_TEST_INPUT_ARCHIVE(ia);
+
+        vector<int> new_a;
+        vector<int> new_b;
+
+        SerializeAndCountFails(new_a, ia, fail_counter);
+        ASSERT_EQUAL(new_a, a);
+        ASSERT_EQUAL(ia.memory_used(), a.size() * sizeof(int));
+        ASSERT_FALSE(fail_counter);
+
+        ia.set_memory_budget(ia.memory_used() + 100);                           // Бюджета не хватает для второго вектора.
+        SerializeAndCountFails(new_b, ia, fail_counter);
+        ASSERT_EQUAL(fail_counter, 1);
+        ASSERT_TRUE(new_b.empty());
+    }
+
+    {
+        CREATE_TEST_INPUT_ARCHIVE(ia);
+
+        vector<int>    new_a;
+        vector<int>    new_b;
+        vector<double> new_c;
+
+        SerializeAndCountFails(new_a, ia, fail_counter);
+        SerializeAndCountFails(new_b, ia, fail_counter);
+        ASSERT_EQUAL(new_b, a);
+        ASSERT_EQUAL(fail_counter, 1);
+
+        SerializeAndCountFails(new_c, ia, fail_counter);                        // Заявленные размеры превышают остаток потока:
+        ASSERT_EQUAL(fail_counter, 2);                                          // память не выделяется.
+        ASSERT_EQUAL(new_c.capacity(), 0);
+    }
+
+    {
+        vector<PodClass> pods(5000, PodClass(-1, 'b', 2, 500));                 // Размер вектора пользовательских классов нельзя проверить
+                                                                                // по размеру потока: вектор растет шагами.
+        ostringstream output;
+        Archive<ostringstream> oa(output);
+        oa << pods;
+
+        istringstream input(output.str());
+        Archive<istringstream> ia(input);
+
+        vector<PodClass> new_pods;
+        SerializeAndCountFails(new_pods, ia, fail_counter);
+
+        ASSERT_EQUAL(new_pods, pods);
+        ASSERT_EQUAL(fail_counter, 2);
+    }
+
+    {
+        ostringstream output;
+        Archive<ostringstream> oa(output);
+        oa << corrupt_size;
+        oa << not_null;
+        oa << corrupt_pointer_size;
+
+        istringstream input(output.str());
+        Archive<istringstream> ia(input);
+
+        list<string>    new_d;
+        Pointer<double> new_e;
+
+        SerializeAndCountFails(new_d, ia, fail_counter);
+        ASSERT_EQUAL(fail_counter, 3);
+        ASSERT_TRUE(new_d.empty());
+
+        istringstream pointer_input(output.str().substr(sizeof(uint32_t)));
+        Archive<istringstream> pointer_ia(pointer_input);
+
+        SerializeAndCountFails(new_e, pointer_ia, fail_counter);
+        ASSERT_EQUAL(fail_counter, 4);
+        ASSERT_FALSE(new_e.ptr);
+    }
+}
+
+void TestErrorCodes()                                                           // режим кодов ошибок
+{
+    PodClass a(-1, 'b', 2, 500);
+    array<string, 2> b = {{ "one", "two" }};                                    // Массивы строк сериализуются с префиксом длины.
+    uint32_t corrupt_size = 0xFFFFFFF0;
+
+    {
+        CREATE_TEST_OUTPUT_ARCHIVE(oa);
+
+        ASSERT_EQUAL(oa.try_serialize(a), Status::Ok);
+        ASSERT_EQUAL(oa.try_serialize(b), Status::Ok);
+        ASSERT_EQUAL(oa.try_serialize(corrupt_size), Status::Ok);
+    }
+
+    {
+        CREATE_TEST_INPUT_ARCHIVE(ia);
+
+        PodClass         new_a;
+        array<string, 1> new_b;
+        vector<string>   new_c;
+
+        ASSERT_EQUAL(ia.try_serialize(new_a), Status::Ok);
+        ASSERT_EQUAL(new_a, a);
+
+        ASSERT_EQUAL(ia.try_serialize(new_b), Status::SizeMismatch);            // Ошибка сохраняется до вызова clear_status():
+        ASSERT_EQUAL(ia.try_serialize(new_c), Status::SizeMismatch);            // последующие вызовы ничего не делают.
+        ASSERT_EQUAL(ia.status(), Status::SizeMismatch);
+        ASSERT_TRUE(new_c.empty());
+
+        ia.clear_status();
+        int* raw_pointer = nullptr;
+        ASSERT_EQUAL(ia.try_serialize(raw_pointer), Status::UnsupportedType);
+
+        ia.clear_status();                                                      // Вне режима кодов ошибок по-прежнему выбрасываются
+        size_t fail_counter = 0;                                                // исключения.
+        SerializeAndCountFails(raw_pointer, ia, fail_counter);
+        ASSERT_EQUAL(fail_counter, 1);
+    }
+
+    {
+        CREATE_TEST_INPUT_ARCHIVE(ia);                                          // Данные в потоке заканчиваются раньше, чем ожидалось.
+
+        PodClass new_a;
+        array<string, 2> new_b;
+        uint32_t new_c = 0;
+        double new_d = 0;
+
+        ASSERT_EQUAL(ia.try_serialize(new_a), Status::Ok);
+        ASSERT_EQUAL(ia.try_serialize(new_b), Status::Ok);
+        ASSERT_EQUAL(ia.try_serialize(new_c), Status::Ok);
+        ASSERT_EQUAL(ia.try_serialize(new_d), Status::UnexpectedEnd);
+        ASSERT_EQUAL(new_b, b);
+        ASSERT_EQUAL(new_c, corrupt_size);
+    }
+}
+
+void TestFixedLayout()                                                          // объекты фиксированного размера
+{
+    static_assert(serialized_size<PodClass>() == 17, "");
+    static_assert(serialized_size<array<PodClass, 3>>() == 51, "");
+    static_assert(serialized_size<pair<int, double>>() == 12, "");
+    static_assert(!fixed_layout<string>::value, "");
+    static_assert(!fixed_layout<ClassWithNestedStruct>::value, "");
+
+    PodClass a(-1, 'b', 2, 500);
+    array<PodClass, 3> b = {{ a, PodClass(1, 'c', 3, -4), PodClass() }};
+    array<int, 5> c = {{ 1, 2, 3, 4, 5 }};
+    array<array<short, 2>, 2> d = {{ {{ 1, 2 }}, {{ 3, 4 }} }};
+    vector<PodClass> e = { a, a };
+    string data;
+
+    {
+        ostringstream output(ios_base::binary);
+        Archive<ostringstream> oa(output);
+        oa << a;
+        oa << b;
+        oa << c;
+        oa << d;
+        oa << e;
+        data = output.str();
+    }
+
+    ASSERT_EQUAL(data.size(), 17 + 51 + 20 + 8 + 4 + 34);                       // Префиксы длины записываются только для вектора.
+
+    {
+        istringstream input(data, ios_base::binary);
+        Archive<istringstream> ia(input);
+
+        PodClass new_a;
+        array<PodClass, 3> new_b;
+        array<int, 5> new_c;
+        array<array<short, 2>, 2> new_d;
+        vector<PodClass> new_e;
+
+        ia >> new_a;
+        ia >> new_b;
+        ia >> new_c;
+        ia >> new_d;
+        ia >> new_e;
+
+        ASSERT_EQUAL(new_a, a);
+        ASSERT_EQUAL(new_b, b);
+        ASSERT_EQUAL(new_c, c);
+        ASSERT_EQUAL(new_d, d);
+        ASSERT_EQUAL(new_e, e);
+    }
+
+    {
+        istringstream input(data.substr(0, 17 + 50), ios_base::binary);         // Данные объекта заканчиваются раньше, чем ожидалось:
+        Archive<istringstream> ia(input);                                       // объект не читается частично.
+
+        PodClass new_a;
+        array<PodClass, 3> new_b;
+
+        ASSERT_EQUAL(ia.try_serialize(new_a), Status::Ok);
+        ASSERT_EQUAL(ia.try_serialize(new_b), Status::UnexpectedEnd);
+        ASSERT_EQUAL(new_b[0], PodClass());
+    }
+
+    MisdeclaredLayout<FixedLayout<int32_t>> narrow;                             // Объявленный размер меньше или больше записываемого
+    MisdeclaredLayout<FixedLayout<int32_t, int32_t, int32_t>> wide;             // методом serialize: буфер не переполняется, запись и
+    {                                                                           // чтение завершаются ошибкой.
+        ostringstream output(ios_base::binary);
+        Archive<ostringstream> oa(output);
+        ASSERT_EQUAL(oa.try_serialize(narrow), Status::InvalidData);
+        oa.clear_status();
+        ASSERT_EQUAL(oa.try_serialize(wide), Status::InvalidData);
+        ASSERT_TRUE(output.str().empty());
+    }
+    {
+        istringstream input(string(16, '\0'), ios_base::binary);
+        Archive<istringstream> ia(input);
+        ASSERT_EQUAL(ia.try_serialize(narrow), Status::InvalidData);
+        ia.clear_status();
+        ASSERT_EQUAL(ia.try_serialize(wide), Status::InvalidData);
+    }
+}
+
+void TestColumnar()                                                             // поколоночная сериализация контейнеров
+{
+    vector<DerivedClass> a = { DerivedClass(1, 0.5, 'x', "first", { 1, 2 }),
+                               DerivedClass(2, 1.5, 'y', "second", {}) };
+    deque<StructWithBasicTypesAndContainers> b = {
+        StructWithBasicTypesAndContainers(1, 2.0, 3.0f, 'a', { 4, 5 }, { 6.0 }),
+        StructWithBasicTypesAndContainers() };
+    list<StructWithBasicTypesAndContainers> c(3);
+    vector<DerivedClass> d;
+    string data;
+
+    {
+        ostringstream output(ios_base::binary);
+        Archive<ostringstream> oa(output);
+        oa << a;
+        oa << b;
+        oa << c;
+        oa << d;
+        data = output.str();
+    }
+
+    uint32_t header[4] = {};                                                    // Количество строк, количество колонок и первая колонка
+    memcpy(header, data.data(), sizeof(header));                                // (поле a базового класса обеих строк подряд).
+    ASSERT_EQUAL(header[0], 2u);
+    ASSERT_EQUAL(header[1], 5u);
+    ASSERT_EQUAL(header[2], 2 * sizeof(int));
+    ASSERT_EQUAL(header[3], 1u);
+
+    {
+        istringstream input(data, ios_base::binary);
+        Archive<istringstream> ia(input);
+
+        vector<DerivedClass> new_a;
+        deque<StructWithBasicTypesAndContainers> new_b;
+        list<StructWithBasicTypesAndContainers> new_c;
+        vector<DerivedClass> new_d(1);
+
+        ia >> new_a;
+        ia >> new_b;
+        ia >> new_c;
+        ia >> new_d;
+
+        ASSERT_EQUAL(new_a, a);
+        ASSERT_EQUAL(new_b, b);
+        ASSERT_EQUAL(new_c, c);
+        ASSERT_EQUAL(new_d, d);
+    }
+
+    {
+        data[sizeof(uint32_t)] = 4;                                             // Колонок меньше, чем полей: данные отсутствующей колонки
+        istringstream input(data, ios_base::binary);                            // заканчиваются раньше, чем ожидалось.
+        Archive<istringstream> ia(input);
+
+        vector<DerivedClass> new_a;
+        ASSERT_EQUAL(ia.try_serialize(new_a), Status::UnexpectedEnd);
+        ASSERT_TRUE(new_a.empty());
+    }
+}
+
+void TestPackedKeys()                                                           // упаковка целочисленных ключей
+{
+    set<int> a;
+    for (int i = -500; i < 500; i++)
+    {
+        a.insert(i * 3);
+    }
+    map<int64_t, string> b = { { -7, "a" }, { 0, "b" }, { 1LL << 40, "c" } };
+    multiset<uint8_t> c = { 1, 1, 2, 255, 255 };
+    multimap<int, int> d = { { 1, 10 }, { 1, 11 }, { 5, 50 } };
+    set<uint64_t> e = { 0, numeric_limits<uint64_t>::max() };
+    set<int> f;
+    string data;
+
+    {
+        ostringstream output(ios_base::binary);
+        Archive<ostringstream> oa(output);
+        oa.set_packed_keys(true);
+        oa << a;
+        data = output.str();                                                    // Разности ключей занимают по 2 бита.
+        ASSERT_TRUE(data.size() < a.size());
+        oa << b;
+        oa << c;
+        oa << d;
+        oa << e;
+        oa << f;
+        data = output.str();
+    }
+
+    {
+        istringstream input(data, ios_base::binary);
+        Archive<istringstream> ia(input);
+        ia.set_packed_keys(true);
+
+        set<int> new_a;
+        map<int64_t, string> new_b;
+        multiset<uint8_t> new_c;
+        multimap<int, int> new_d;
+        set<uint64_t> new_e;
+        set<int> new_f = { 1 };
+
+        ia >> new_a;
+        ia >> new_b;
+        ia >> new_c;
+        ia >> new_d;
+        ia >> new_e;
+        ia >> new_f;
+
+        ASSERT_EQUAL(new_a, a);
+        ASSERT_EQUAL(new_b, b);
+        ASSERT_EQUAL(new_c, c);
+        ASSERT_EQUAL(new_d, d);
+        ASSERT_EQUAL(new_e, e);
+        ASSERT_EQUAL(new_f, f);
+    }
+
+    {
+        data[2 * sizeof(uint32_t)] = 65;                                        // Ширина первого блока больше 64 бит.
+        istringstream input(data, ios_base::binary);
+        Archive<istringstream> ia(input);
+        ia.set_packed_keys(true);
+
+        set<int> new_a;
+        ASSERT_EQUAL(ia.try_serialize(new_a), Status::InvalidData);
+    }
+}
+
+static string SerializeEvents(vector<ClassWithNestedStruct>& events,            // Функция для сериализации событий с повторяющимися строками
+                              map<string, int>& counters,                       // (со словарем строк или без него).
+                              bool dictionary)
+{
+    ostringstream output(ios_base::binary);
+    Archive<ostringstream> oa(output);
+    oa.set_string_dictionary(dictionary);
+    oa << events;
+    oa << counters;
+    return output.str();
+}
+
+void TestStringDictionary()                                                     // словарь строк архива
+{
+    vector<ClassWithNestedStruct> a(10);
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        a[i] = ClassWithNestedStruct(int(i), {}, 0.5f, "event.user.login", {},
+                                     { "one", "two", to_string(i % 3) });
+    }
+    map<string, int> b = { { "one", 1 }, { "event.user.login", 2 }, { "x", 3 } };
+    vector<DerivedClass> c(3, DerivedClass(1, 2.0, 'c', "repeated", { 1 }));
+
+    string data = SerializeEvents(a, b, true);
+    ASSERT_TRUE(data.size() < SerializeEvents(a, b, false).size());
+
+    {
+        ostringstream output(ios_base::binary);                                 // Колонки используют словарь архива.
+        Archive<ostringstream> oa(output);
+        oa.set_string_dictionary(true);
+        oa << c;
+        data += output.str();
+    }
+
+    {
+        istringstream input(data, ios_base::binary);
+        Archive<istringstream> ia(input);
+        ia.set_string_dictionary(true);
+
+        vector<ClassWithNestedStruct> new_a;
+        map<string, int> new_b;
+        ia >> new_a;
+        ia >> new_b;
+
+        ia.clear_string_dictionary();                                           // Колонки записаны отдельным архивом.
+        vector<DerivedClass> new_c;
+        ia >> new_c;
+
+        ASSERT_EQUAL(new_a, a);
+        ASSERT_EQUAL(new_b, b);
+        ASSERT_EQUAL(new_c, c);
+    }
+
+    {
+        uint32_t reference = 2;                                                 // Ссылка на строку, которой нет в словаре.
+        istringstream input(string(reinterpret_cast<char*>(&reference),
+                                   sizeof(reference)), ios_base::binary);
+        Archive<istringstream> ia(input);
+        ia.set_string_dictionary(true);
+
+        string new_d;
+        ASSERT_EQUAL(ia.try_serialize(new_d), Status::InvalidData);
+    }
+}
+
+static vector<double> CreateSeries(size_t size)                                 // Функция для создания временного ряда: медленно меняющиеся
+{                                                                               // показания датчика с точностью 0.01, которые часто
+    mt19937 generator(2020);                                                    // повторяются.
+    vector<double> series(size);
+    double value = 20.0;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        if (generator() % 4 == 0)
+        {
+            value += (int(generator() % 21) - 10) / 100.0;
+            value = round(value * 100) / 100;
+        }
+        series[i] = value;
+    }
+    return series;
+}
+
+void TestCompressedFloats()                                                     // сжатие чисел с плавающей точкой
+{
+    vector<double> a = CreateSeries(1000);
+    forward_list<double> b = { 1.5, -0.0, numeric_limits<double>::infinity(),
+                               numeric_limits<double>::denorm_min(), 1.5 };
+    deque<float> c = { 3.25f, 3.25f, 3.5f, -1e30f, 0.0f };
+    list<float> d;
+    string data;
+    size_t raw_size = 0;
+
+    {
+        ostringstream output(ios_base::binary);
+        Archive<ostringstream> oa(output);
+        oa << a;
+        raw_size = output.str().size();
+    }
+
+    {
+        ostringstream output(ios_base::binary);
+        Archive<ostringstream> oa(output);
+        oa.set_compressed_floats(true);
+        oa << a;
+        ASSERT_TRUE(output.str().size() * 3 < raw_size);                        // Сжатый ряд как минимум втрое меньше.
+        oa << b;
+        oa << c;
+        oa << d;
+        data = output.str();
+    }
+
+    {
+        istringstream input(data, ios_base::binary);
+        Archive<istringstream> ia(input);
+        ia.set_compressed_floats(true);
+
+        vector<double> new_a;
+        forward_list<double> new_b;
+        deque<float> new_c;
+        list<float> new_d = { 1.0f };
+
+        ia >> new_a;
+        ia >> new_b;
+        ia >> new_c;
+        ia >> new_d;
+
+        ASSERT_EQUAL(new_a, a);
+        ASSERT_EQUAL(new_b, b);
+        ASSERT_TRUE(signbit(*next(new_b.begin())));                             // Знак нуля сохраняется.
+        ASSERT_EQUAL(new_c, c);
+        ASSERT_EQUAL(new_d, d);
+    }
+
+    {
+        uint32_t header[2] = { 1000, 8 };                                       // 1000 значений не помещаются в 8 байт.
+        istringstream input(string(reinterpret_cast<char*>(header),
+                                   sizeof(header)), ios_base::binary);
+        Archive<istringstream> ia(input);
+        ia.set_compressed_floats(true);
+
+        vector<double> new_a;
+        ASSERT_EQUAL(ia.try_serialize(new_a), Status::InvalidData);
+    }
+}
+
+void TestDeltaSnapshots()                                                       // разностные снимки
+{
+    vector<int64_t> state(20000, 7);                                            // 160 КБ – 40 блоков по 4 КБ.
+    SnapshotWriter writer;
+    ostringstream output(ios_base::binary);
+    vector<size_t> sizes;                                                       // Размеры снимков в потоке.
+
+    auto write = [&]
+    {
+        size_t begin = output.str().size();
+        writer.write(state, output);
+        sizes.push_back(output.str().size() - begin);
+    };
+
+    write();
+    ASSERT_EQUAL(writer.changed_chunks(), 40u);
+
+    state[100] = -1;                                                            // Изменение двух элементов – два блока.
+    state[15000] = -2;
+    write();
+    ASSERT_EQUAL(writer.changed_chunks(), 2u);
+    ASSERT_TRUE(sizes[1] * 10 < sizes[0]);
+
+    state.resize(20100, 1);                                                     // Изменение размера – блок с размером вектора и последние
+    write();                                                                    // блоки.
+    ASSERT_EQUAL(writer.changed_chunks(), 2u);
+
+    state.resize(19000);
+    write();
+    ASSERT_EQUAL(writer.changed_chunks(), 2u);
+
+    write();                                                                    // Без изменений.
+    ASSERT_EQUAL(writer.changed_chunks(), 0u);
+
+    {
+        istringstream input(output.str(), ios_base::binary);
+        SnapshotReader reader;
+        vector<int64_t> new_state;
+
+        for (size_t i = 0; i < sizes.size(); i++)
+        {
+            reader.read(input, new_state);
+        }
+        ASSERT_EQUAL(new_state, state);
+    }
+
+    {
+        istringstream input(output.str().substr(sizes[0]), ios_base::binary);   // Снимок без базы не применяется.
+        SnapshotReader reader;
+        vector<int64_t> new_state;
+        size_t fail_counter = 0;
+
+        try
+        {
+            reader.read(input, new_state);
+        }
+        catch (const invalid_argument&)
+        {
+            fail_counter++;
+        }
+        ASSERT_EQUAL(fail_counter, 1u);
+        ASSERT_TRUE(reader.data().empty());
+    }
+}
+
+#ifdef __linux__
+static void BreakIoUring()                                                      // Функция для подмены дескрипторов очередей io_uring на
+{                                                                               // /dev/null: следующая отправка операций завершается
+    int null_fd = open("/dev/null", O_RDONLY);                                  // ошибкой (отображенные кольца и уже отправленные
+    for (int fd = 0; fd < 1024; fd++)                                           // операции сохраняются).
+    {
+        char link[64];
+        char target[256];
+        snprintf(link, sizeof(link), "/proc/self/fd/%d", fd);
+        ssize_t size = readlink(link, target, sizeof(target));
+        if (size > 0 && string(target, size).find("io_uring") != string::npos)
+        {
+            dup2(null_fd, fd);
+        }
+    }
+    close(null_fd);
+}
+#endif
+
+void TestFileStreams()                                                          // файловые приемник и источник
+{
+    ClassWithNestedStruct a(1,
+                            { 20, 30, 40 },
+                            500.00,
+                            "6k",
+                            StructWithBasicTypesAndContainers(2,
+                                                              0.35,
+                                                              3.1,
+                                                              'u',
+                                                              { 90, 100, 30 },
+                                                              { 0.5, 0.6 }),
+                            { "70k", "80k", "90k" });
+    vector<int64_t> values(100000);                                             // 800 КБ – много заполнений маленьких буферов.
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        values[i] = int64_t(i * i);
+    }
+
+    for (int use_io_uring = 0; use_io_uring < 2; use_io_uring++)                // Проверяем синхронный и асинхронный режимы.
+    {
+        {
+            FileSink sink("test.bin", 4096, 3, use_io_uring);
+            Archive<FileSink> oa(sink);
+            oa << a;
+            oa << values;
+            if (!use_io_uring)
+            {
+                ASSERT_FALSE(sink.asynchronous());
+            }
+        }
+
+        {
+            ifstream input("test.bin", ios_base::binary);                       // Файл совпадает с записанным через стандартный поток.
+            ostringstream expected(ios_base::binary);
+            Archive<ostringstream> oa(expected);
+            oa << a;
+            oa << values;
+            ASSERT_EQUAL(string(istreambuf_iterator<char>(input), {}),
+                         expected.str());
+        }
+
+        {
+            FileSource source("test.bin", 4096, 3, use_io_uring);
+            Archive<FileSource> ia(source);
+
+            ClassWithNestedStruct new_a;
+            vector<int64_t> new_values;
+            ia >> new_a;
+            ia >> new_values;
+            ASSERT_EQUAL(new_a, a);
+            ASSERT_EQUAL(new_values, values);
+            ASSERT_FALSE(!source);
+            ASSERT_EQUAL(source.input_size(), 0u);
+        }
+
+        {
+            FileSource source("test.bin", 4096, 3, use_io_uring);               // Данные закончились раньше, чем ожидалось.
+            Archive<FileSource> ia(source);
+
+            ClassWithNestedStruct new_a;
+            vector<int64_t> new_values;
+            ia >> new_a;
+            ia >> new_values;
+            ASSERT_EQUAL(ia.try_serialize(new_values), Status::UnexpectedEnd);
+            ASSERT_TRUE(!source);
+        }
+    }
+
+    size_t fail_counter = 0;
+    try
+    {
+        FileSource source("missing/test.bin");
+    }
+    catch (const runtime_error&)
+    {
+        fail_counter++;
+    }
+    ASSERT_EQUAL(fail_counter, 1u);
+
+#ifdef __linux__
+    {
+        FileSource source("test.bin", 4096, 3);                                 // Ошибка отправки чтения: отправленные чтения
+        if (source.asynchronous())                                              // дожидаются, дальше чтение синхронное.
+        {
+            this_thread::sleep_for(chrono::milliseconds(100));
+            BreakIoUring();
+        }
+        Archive<FileSource> ia(source);
+
+        ClassWithNestedStruct new_a;
+        vector<int64_t> new_values;
+        ia >> new_a;
+        ia >> new_values;
+        ASSERT_EQUAL(new_a, a);
+        ASSERT_EQUAL(new_values, values);
+        ASSERT_FALSE(source.asynchronous());
+    }
+
+    {
+        {
+            FileSink sink("test.bin", 4096, 3);                                 // Ошибка отправки записи.
+            Archive<FileSink> oa(sink);
+            oa << a;
+            if (sink.asynchronous())
+            {
+                this_thread::sleep_for(chrono::milliseconds(100));
+                BreakIoUring();
+            }
+            oa << values;
+            ASSERT_FALSE(sink.asynchronous());
+        }
+
+        FileSource source("test.bin", 4096, 3, false);
+        Archive<FileSource> ia(source);
+        ClassWithNestedStruct new_a;
+        vector<int64_t> new_values;
+        ia >> new_a;
+        ia >> new_values;
+        ASSERT_EQUAL(new_a, a);
+        ASSERT_EQUAL(new_values, values);
+    }
+
+    for (int use_io_uring = 0; use_io_uring < 2; use_io_uring++)                // Ошибка записи (на устройстве нет места) выбрасывается
+    {                                                                           // из write или close, буферы освобождаются после
+        fail_counter = 0;                                                       // завершения операций.
+        try
+        {
+            FileSink sink("/dev/full", 4096, 2, use_io_uring);
+            string data(3 * 4096, 'x');
+            sink.write(data.data(), data.size());
+            sink.close();
+        }
+        catch (const runtime_error&)
+        {
+            fail_counter++;
+        }
+        ASSERT_EQUAL(fail_counter, 1u);
+
+        fail_counter = 0;
+        try
+        {
+            FileSink sink("/dev/full", 4096, 2, use_io_uring);
+            sink.write("x", 1);
+            sink.close();
+        }
+        catch (const runtime_error&)
+        {
+            fail_counter++;
+        }
+        ASSERT_EQUAL(fail_counter, 1u);
+    }
+#endif
+}
+
+void TestGatherSink()                                                           // запись без копирования массивов
+{
+    vector<int64_t> values(10000, 42);                                          // Большие массивы передаются по ссылке,
+    string text(5000, 'x');                                                     // маленькие копируются.
+    vector<double> small = { 0.5, 1.5 };
+    map<int, string> m = { { 1, "one" }, { 2, string(2000, 'y') } };
+
+    ostringstream expected(ios_base::binary);
+    {
+        Archive<ostringstream> oa(expected);
+        oa << values;
+        oa << text;
+        oa << small;
+        oa << m;
+    }
+
+    int fd = ::open("test.bin", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_TRUE(fd >= 0);
+    {
+        GatherSink sink(fd);
+        Archive<GatherSink> oa(sink);
+        oa << values;
+        oa << text;
+        oa << small;
+        oa << m;
+        sink.flush();
+
+        ASSERT_EQUAL(sink.referenced_bytes(),
+                     values.size() * sizeof(int64_t) + text.size() + 2000);
+        ASSERT_EQUAL(sink.copied_bytes() + sink.referenced_bytes(),
+                     expected.str().size());
+    }
+    ::close(fd);
+
+    ifstream input("test.bin", ios_base::binary);                               // Данные совпадают с записью в стандартный поток.
+    ASSERT_EQUAL(string(istreambuf_iterator<char>(input), {}), expected.str());
+
+    int pipe_fds[2];                                                            // Запись в канал с маленьким промежуточным буфером
+    ASSERT_EQUAL(pipe(pipe_fds), 0);                                            // (данные читаются из канала после каждого объекта).
+    ostringstream expected_items(ios_base::binary);
+    string received;
+    {
+        GatherSink sink(pipe_fds[1], 16, 64);
+        Archive<GatherSink> oa(sink);
+        Archive<ostringstream> expected_oa(expected_items);
+        for (auto& item : m)
+        {
+            oa << item;
+            expected_oa << item;
+            sink.flush();
+
+            char buffer[4096];
+            ssize_t count = read(pipe_fds[0], buffer, sizeof(buffer));
+            ASSERT_TRUE(count > 0);
+            received.append(buffer, size_t(count));
+        }
+    }
+    ::close(pipe_fds[0]);
+    ::close(pipe_fds[1]);
+    ASSERT_EQUAL(received, expected_items.str());
+
+    ASSERT_EQUAL(pipe(pipe_fds), 0);                                            // Ошибка записи (переполнение неблокирующего канала):
+    fcntl(pipe_fds[1], F_SETFL, O_NONBLOCK);                                    // повторный flush() продолжает с места ошибки без
+    fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK);                                    // повторной записи уже записанных данных.
+    received.clear();
+    size_t fail_counter = 0;
+    {
+        GatherSink sink(pipe_fds[1]);
+        Archive<GatherSink> oa(sink);
+        oa << values;
+        oa << text;
+        oa << small;
+        oa << m;
+
+        for (bool flushed = false; !flushed;)
+        {
+            try
+            {
+                sink.flush();
+                flushed = true;
+            }
+            catch (const runtime_error&)
+            {
+                fail_counter++;
+            }
+
+            char buffer[4096];
+            ssize_t count = 0;
+            while ((count = read(pipe_fds[0], buffer, sizeof(buffer))) > 0)
+            {
+                received.append(buffer, size_t(count));
+            }
+        }
+    }
+    ::close(pipe_fds[0]);
+    ::close(pipe_fds[1]);
+    ASSERT_TRUE(fail_counter > 0);
+    ASSERT_EQUAL(received, expected.str());
+}
+
+void TestSharedArchive()                                                        // запись в архив из нескольких потоков
+{
+    const int producers = 4;
+    const int records = 2000;
+    SharedArchive log(1 << 20);
+
+    atomic<bool> done(false);
+    size_t broken_snapshots = 0;
+    thread reader([&]                                                           // Данные, прочитанные во время добавления записей,
+    {                                                                           // состоят из целых записей.
+        while (!done)
+        {
+            istringstream input(log.data(), ios_base::binary);
+            Archive<istringstream> ia(input);
+            vector<int> record;
+            while (input.peek() != EOF)
+            {
+                if (ia.try_serialize(record) != Status::Ok ||
+                    record.size() != 2)
+                {
+                    broken_snapshots++;
+                    break;
+                }
+            }
+        }
+    });
+
+    vector<thread> threads;
+    for (int producer = 0; producer < producers; producer++)
+    {
+        threads.emplace_back([&log, producer]
+        {
+            for (int i = 0; i < records; i++)
+            {
+                vector<int> record = { producer, i };                           // Запись – номер потока и номер записи.
+                log.append(record);
+            }
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    done = true;
+    reader.join();
+    ASSERT_FALSE(broken_snapshots);
+
+    ASSERT_EQUAL(log.appended_records(), size_t(producers * records));
+    ASSERT_FALSE(log.dropped_records());
+
+    istringstream input(log.data(), ios_base::binary);                          // Записи каждого потока идут в порядке добавления.
+    Archive<istringstream> ia(input);
+    vector<int> next(producers, 0);
+    for (int i = 0; i < producers * records; i++)
+    {
+        vector<int> record;
+        ia >> record;
+        ASSERT_EQUAL(record.size(), 2u);
+        ASSERT_TRUE(record[0] >= 0 && record[0] < producers);
+        ASSERT_EQUAL(record[1], next[record[0]]++);
+    }
+    ASSERT_EQUAL(next, vector<int>(producers, records));
+    ASSERT_EQUAL(ia.try_serialize(next), Status::UnexpectedEnd);
+
+    SharedArchive small(64);                                                    // Запись, для которой не хватает места, отбрасывается.
+    string text(40, 'x');
+    ASSERT_TRUE(small.append(text));
+    ASSERT_FALSE(small.append(text));
+    ASSERT_EQUAL(small.size(), 44u);
+    ASSERT_EQUAL(small.dropped_records(), 1u);
+
+    small.clear();
+    ASSERT_TRUE(small.append(text));
+    ASSERT_EQUAL(small.appended_records(), 1u);
+}
+
+void TestParallelScanner()                                                      // параллельная обработка файла записей
+{
+    ostringstream output(ios_base::binary);
+    RecordWriter writer(output);
+    vector<vector<int>> records(3000);
+    for (size_t i = 0; i < records.size(); i++)                                 // Записи разного размера (каждая сотая – большая).
+    {
+        records[i].assign(i % 100 ? i % 7 : 5000, int(i));
+        writer.write(records[i]);
+    }
+    const string data = output.str();
+
+    for (size_t threads = 1; threads <= 4; threads++)
+    {
+        ParallelScanner scanner(threads);
+        vector<vector<int>> new_records(records.size());
+        atomic<size_t> calls(0);
+
+        size_t count = scanner.scan<vector<int>>(data,
+            [&](size_t index, vector<int>& record)
+            {
+                new_records[index] = std::move(record);
+                calls++;
+            });
+
+        ASSERT_EQUAL(count, records.size());
+        ASSERT_EQUAL(calls.load(), records.size());
+        ASSERT_EQUAL(new_records, records);
+    }
+
+    ParallelScanner scanner(4);
+    ASSERT_EQUAL(scanner.scan<vector<int>>(string(),                            // Пустой файл.
+                     [](size_t, vector<int>&) {}), 0u);
+
+    size_t fail_counter = 0;
+    try                                                                         // Последняя запись обрезана.
+    {
+        scanner.scan<vector<int>>(data.substr(0, data.size() - 1),
+                                  [](size_t, vector<int>&) {});
+    }
+    catch (const invalid_argument&)
+    {
+        fail_counter++;
+    }
+
+    try                                                                         // Исключение функции обратного вызова прерывает обработку.
+    {
+        scanner.scan<vector<int>>(data, [](size_t index, vector<int>&)
+        {
+            if (index == 1234)
+            {
+                throw runtime_error("callback");
+            }
+        });
+    }
+    catch (const runtime_error& e)
+    {
+        ASSERT_EQUAL(string(e.what()), "callback");
+        fail_counter++;
+    }
+
+    ostringstream padded_output(ios_base::binary);                              // Запись с лишним байтом после объекта.
+    RecordWriter padded_writer(padded_output);
+    vector<int> record = { 1, 2 };
+    padded_writer.write(record);
+    string padded = padded_output.str();
+    padded[0]++;
+    padded += '\0';
+    try
+    {
+        scanner.scan<vector<int>>(padded, [](size_t, vector<int>&)
+        {
+            throw runtime_error("callback");
+        });
+    }
+    catch (const invalid_argument&)
+    {
+        fail_counter++;
+    }
+    ASSERT_EQUAL(fail_counter, 3u);
+
+    atomic<bool> stop(false);                                                   // При исключении (например, ошибке запуска следующего
+    atomic<int> finished(0);                                                    // потока) запущенные потоки останавливаются и
+    try                                                                         // дожидаются.
+    {
+        WorkerThreads workers(&stop);
+        workers.start([&]
+        {
+            while (!stop)
+            {
+                this_thread::yield();
+            }
+            finished++;
+        });
+        throw runtime_error("start");
+    }
+    catch (const runtime_error&)
+    {
+        fail_counter++;
+    }
+    ASSERT_EQUAL(finished.load(), 1);
+    ASSERT_EQUAL(fail_counter, 4u);
+}
+
+void TestLazySequence()                                                         // ленивое чтение контейнеров
+{
+    vector<string> a;
+    for (int i = 0; i < 1000; i++)
+    {
+        a.push_back("item #" + to_string(i));
+    }
+    list<vector<int>> b = { { 1, 2 }, {}, { 3 } };
+    forward_list<int> c;
+    int d = 42;
+
+    ostringstream output(ios_base::binary);
+    {
+        Archive<ostringstream> oa(output);
+        oa << a;
+        oa << b;
+        oa << c;
+        oa << d;
+    }
+
+    {
+        istringstream input(output.str(), ios_base::binary);
+        Archive<istringstream> ia(input);
+
+        auto strings = ia.lazy<vector<string>>();
+        ASSERT_EQUAL(strings.size(), 1000u);
+        size_t i = 0;
+        for (auto& item : strings)                                              // Элементы читаются по одному.
+        {
+            ASSERT_EQUAL(item, a[i++]);
+        }
+        ASSERT_EQUAL(i, a.size());
+
+        list<vector<int>> new_b;
+        auto vectors = ia.lazy<list<vector<int>>>();
+        for (auto it = vectors.begin(); it != vectors.end(); ++it)
+        {
+            new_b.push_back(*it);
+        }
+        ASSERT_EQUAL(new_b, b);
+
+        auto empty = ia.lazy<forward_list<int>>();                              // Пустой контейнер.
+        ASSERT_TRUE(empty.begin() == empty.end());
+
+        int new_d = 0;                                                          // После последовательности архив читается дальше.
+        ia >> new_d;
+        ASSERT_EQUAL(new_d, d);
+    }
+
+    {
+        vector<string> large(100, string(1000, 'x'));                           // Бюджет памяти учитывает только текущий элемент
+        ostringstream large_output(ios_base::binary);                           // (при чтении всего вектора бюджета не хватает).
+        {
+            Archive<ostringstream> oa(large_output);
+            oa << large;
+        }
+
+        istringstream input(large_output.str(), ios_base::binary);
+        Archive<istringstream> ia(input);
+        ia.set_memory_budget(10000);
+        size_t count = 0;
+        for (auto& item : ia.lazy<vector<string>>())
+        {
+            ASSERT_EQUAL(item, large[count++]);
+        }
+        ASSERT_EQUAL(count, large.size());
+        ASSERT_TRUE(ia.memory_used() < 10000);
+
+        istringstream whole_input(large_output.str(), ios_base::binary);
+        Archive<istringstream> whole_ia(whole_input);
+        whole_ia.set_memory_budget(10000);
+        vector<string> new_large;
+        ASSERT_EQUAL(whole_ia.try_serialize(new_large),
+                     Status::BudgetExceeded);
+    }
+
+    size_t fail_counter = 0;
+    {
+        istringstream input(output.str().substr(0, 500), ios_base::binary);     // Данные закончились посреди последовательности.
+        Archive<istringstream> ia(input);
+        size_t count = 0;
+        try
+        {
+            for (auto& item : ia.lazy<vector<string>>())
+            {
+                ASSERT_EQUAL(item, a[count++]);
+            }
+        }
+        catch (const invalid_argument&)
+        {
+            fail_counter++;
+        }
+        ASSERT_TRUE(count > 0 && count < a.size());
+    }
+
+    {
+        vector<double> series = { 0.5, 1.5 };                                   // Сжатые числа с плавающей точкой не читаются
+        ostringstream compressed(ios_base::binary);                             // по одному.
+        {
+            Archive<ostringstream> oa(compressed);
+            oa.set_compressed_floats(true);
+            oa << series;
+        }
+
+        istringstream input(compressed.str(), ios_base::binary);
+        Archive<istringstream> ia(input);
+        ia.set_compressed_floats(true);
+        try
+        {
+            ia.lazy<vector<double>>();
+        }
+        catch (const invalid_argument&)
+        {
+            fail_counter++;
+        }
+    }
+    ASSERT_EQUAL(fail_counter, 2u);
+}
+
+void TestSharedPointers()                                                       // разделяемые объекты
+{
+    vector<int> buffer(100000, 7);                                              // Десять указателей на один буфер.
+    vector<Pointer<vector<int>>> a(10, { &buffer, AllocType::Static });
+    string data[2];
+
+    for (int shared = 0; shared < 2; shared++)
+    {
+        ostringstream output(ios_base::binary);
+        Archive<ostringstream> oa(output);
+        oa.set_shared_pointers(shared == 1);
+        oa << a;
+        data[shared] = output.str();
+    }
+    ASSERT_TRUE(data[1].size() * 9 < data[0].size());                           // Буфер записан один раз.
+
+    {
+        istringstream input(data[1], ios_base::binary);
+        Archive<istringstream> ia(input);
+        ia.set_shared_pointers(true);
+        vector<Pointer<vector<int>>> new_a;
+        ia >> new_a;
+
+        ASSERT_EQUAL(new_a.size(), a.size());
+        ASSERT_EQUAL(*new_a[0], buffer);
+        ASSERT_TRUE(new_a[0].alloc_type == AllocType::DynamicSingle);           // Первый указатель владеет буфером,
+        for (auto& pointer : new_a)                                             // остальные ссылаются на него.
+        {
+            ASSERT_TRUE(pointer.ptr == new_a[0].ptr);
+        }
+        ASSERT_TRUE(new_a[9].alloc_type == AllocType::Shared);
+        ASSERT_TRUE(ia.memory_used() < 2 * buffer.size() * sizeof(int));        // Память выделена под буфер один раз.
+        delete new_a[0].ptr;
+    }
+
+    GraphNode nodes[3];                                                         // Цикл из трех узлов с общими данными.
+    for (int i = 0; i < 3; i++)
+    {
+        nodes[i].value = i + 1;
+        nodes[i].next = { &nodes[(i + 1) % 3], AllocType::Static };
+        nodes[i].data = { &buffer, AllocType::Static };
+    }
+    Pointer<GraphNode> head = { &nodes[0], AllocType::Static };
+
+    ostringstream output(ios_base::binary);
+    {
+        Archive<ostringstream> oa(output);
+        oa.set_shared_pointers(true);
+        oa << head;
+    }
+
+    {
+        istringstream input(output.str(), ios_base::binary);
+        Archive<istringstream> ia(input);
+        ia.set_shared_pointers(true);
+        Pointer<GraphNode> new_head;
+        ia >> new_head;
+
+        GraphNode* node = new_head.ptr;
+        for (int i = 0; i < 3; i++)
+        {
+            ASSERT_EQUAL(node->value, i + 1);
+            ASSERT_EQUAL(*node->data, buffer);
+            ASSERT_TRUE(node->data.ptr == new_head.ptr->data.ptr);
+            node = node->next.ptr;
+        }
+        ASSERT_TRUE(node == new_head.ptr);                                      // Цикл восстановлен.
+
+        delete new_head.ptr->data.ptr;
+        delete new_head.ptr->next.ptr->next.ptr;
+        delete new_head.ptr->next.ptr;
+        delete new_head.ptr;
+    }
+
+    {
+        ostringstream corrupt(ios_base::binary);                                // Ссылка на объект, которого нет в таблице.
+        {
+            Archive<ostringstream> oa(corrupt);
+            bool ptr_is_null = false;
+            uint32_t reference = 5;
+            oa << ptr_is_null;
+            oa << reference;
+        }
+
+        istringstream input(corrupt.str(), ios_base::binary);
+        Archive<istringstream> ia(input);
+        ia.set_shared_pointers(true);
+        Pointer<vector<int>> pointer;
+        ASSERT_EQUAL(ia.try_serialize(pointer), Status::InvalidData);
+        ASSERT_TRUE(pointer.ptr == nullptr);
+    }
+
+    {
+        int value = 3;                                                          // Второй указатель ссылается на объект первого.
+        vector<Pointer<int>> b(2, { &value, AllocType::Static });
+        ostringstream output(ios_base::binary);
+        {
+            Archive<ostringstream> oa(output);
+            oa.set_shared_pointers(true);
+            oa << b;
+        }
+        istringstream input(output.str(), ios_base::binary);
+        Archive<istringstream> ia(input);
+        ia.set_shared_pointers(true);
+        vector<Pointer<int>> new_b;
+        ia >> new_b;
+        ASSERT_TRUE(new_b[1].alloc_type == AllocType::Shared);
+
+        int first = 10;                                                         // Повторное чтение архива, в котором указатели
+        int second = 20;                                                        // ссылаются на разные объекты: второй указатель
+        vector<Pointer<int>> c = { { &first, AllocType::Static },               // не читает данные в объект первого.
+                                   { &second, AllocType::Static } };
+        ostringstream distinct_output(ios_base::binary);
+        {
+            Archive<ostringstream> oa(distinct_output);
+            oa.set_shared_pointers(true);
+            oa << c;
+        }
+        istringstream distinct_input(distinct_output.str(), ios_base::binary);
+        Archive<istringstream> distinct_ia(distinct_input);
+        distinct_ia.set_shared_pointers(true);
+        distinct_ia >> new_b;
+        ASSERT_EQUAL(*new_b[0], 10);
+        ASSERT_EQUAL(*new_b[1], 20);
+        ASSERT_TRUE(new_b[1].alloc_type == AllocType::DynamicSingle);
+        delete new_b[0].ptr;
+        delete new_b[1].ptr;
+
+        int single = 0;                                                         // Чтение массива в память пользователя не выходит
+        Pointer<int> single_pointer(&single, AllocType::Static);                // за ее границы.
+        int values[5] = { 1, 2, 3, 4, 5 };
+        Pointer<int> array_pointer(values, AllocType::Static, 5);
+        ostringstream array_output(ios_base::binary);
+        {
+            Archive<ostringstream> oa(array_output);
+            oa << array_pointer;
+        }
+        istringstream array_input(array_output.str(), ios_base::binary);
+        Archive<istringstream> array_ia(array_input);
+        ASSERT_EQUAL(array_ia.try_serialize(single_pointer),
+                     Status::InvalidData);
+        ASSERT_EQUAL(single, 0);
+    }
+}
+
+void TestPolymorphic()                                                          // сериализация через базовый класс
+{
+    vector<Polymorphic<Message>> a;
+    a.emplace_back(new TextMessage(1, "text"));
+    a.emplace_back(new ValueMessage(2, { 0.5, 1.5 }));
+    a.emplace_back();
+    a.emplace_back(new TextMessage(4, string(100, 'x')));
+
+    ASSERT_EQUAL(a[0].type_id(), 1u);                                           // Номер типа – позиция в списке наследников.
+    ASSERT_EQUAL(a[1].type_id(), 2u);
+    ASSERT_EQUAL(a[2].type_id(), 0u);
+
+    Message* base = new ValueMessage(5, { 2.5 });                               // Номер определяется по динамическому типу.
+    a.emplace_back(base);
+    ASSERT_EQUAL(a[4].type_id(), 2u);
+
+    size_t fail_counter = 0;
+
+    TextMessage* urgent = new UrgentTextMessage(6, "urgent");                   // Незарегистрированный наследник не обрезается
+    Polymorphic<Message> replaced(new TextMessage(7, "text"));                  // до TextMessage.
+    size_t throw_counter = 0;
+    try
+    {
+        Polymorphic<Message> message(urgent);
+    }
+    catch (const invalid_argument&)
+    {
+        throw_counter++;
+    }
+    try
+    {
+        replaced.reset(new UrgentTextMessage(8, "urgent"));
+    }
+    catch (const invalid_argument&)
+    {
+        throw_counter++;
+    }
+    ASSERT_EQUAL(throw_counter, 2u);
+    ASSERT_EQUAL(replaced->id, 7);
+    ASSERT_EQUAL(replaced.type_id(), 1u);
+
+    {
+        CREATE_TEST_OUTPUT_ARCHIVE(oa);
+        SerializeAndCountFails(a, oa, fail_counter);
+    }
+
+    {
+        CREATE_TEST_INPUT_ARCHIVE(ia);
+        vector<Polymorphic<Message>> new_a;
+        new_a.emplace_back(new ValueMessage(9, { 9.0 }));                       // Прежние объекты заменяются.
+        SerializeAndCountFails(new_a, ia, fail_counter);
+
+        ASSERT_EQUAL(new_a.size(), a.size());
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            ASSERT_EQUAL(new_a[i].type_id(), a[i].type_id());
+        }
+        ASSERT_EQUAL(new_a[0]->id, 1);
+        ASSERT_EQUAL(static_cast<TextMessage&>(*new_a[0]).text, "text");
+        ASSERT_EQUAL(static_cast<ValueMessage&>(*new_a[1]).values,
+                     vector<double>({ 0.5, 1.5 }));
+        ASSERT_TRUE(new_a[2].get() == nullptr);
+        ASSERT_EQUAL(static_cast<TextMessage&>(*new_a[3]).text,
+                     string(100, 'x'));
+        ASSERT_EQUAL(static_cast<ValueMessage&>(*new_a[4]).values,
+                     vector<double>({ 2.5 }));
+    }
+    ASSERT_FALSE(fail_counter);
+
+    {
+        ostringstream output(ios_base::binary);                                 // Неизвестный номер типа.
+        {
+            Archive<ostringstream> oa(output);
+            uint32_t id = 3;
+            oa << id;
+        }
+
+        istringstream input(output.str(), ios_base::binary);
+        Archive<istringstream> ia(input);
+        Polymorphic<Message> message;
+        ASSERT_EQUAL(ia.try_serialize(message), Status::InvalidData);
+        ASSERT_TRUE(message.get() == nullptr);
+    }
+}
+
+void TestCoalescedFields()                                                      // объединение подряд идущих фундаментальных полей
+{
+    SensorSample<true> a;
+    a.id = -7;
+    a.kind = 'k';
+    a.x = 1.5;
+    a.y = -2.25;
+    a.name = "sensor";
+    a.flags = 0x8001;
+    a.time = 1234567890123;
+
+    SensorSample<false> separate;
+    separate.id = a.id;
+    separate.kind = a.kind;
+    separate.x = a.x;
+    separate.y = a.y;
+    separate.name = a.name;
+    separate.flags = a.flags;
+    separate.time = a.time;
+
+    ostringstream coalesced_output(ios_base::binary);                           // Формат совпадает с сериализацией полей по одному.
+    {
+        Archive<ostringstream> oa(coalesced_output);
+        oa << a;
+    }
+    ostringstream separate_output(ios_base::binary);
+    {
+        Archive<ostringstream> oa(separate_output);
+        oa << separate;
+    }
+    ASSERT_EQUAL(coalesced_output.str(), separate_output.str());
+
+    {
+        istringstream input(coalesced_output.str(), ios_base::binary);
+        Archive<istringstream> ia(input);
+        SensorSample<true> new_a;
+        ia >> new_a;
+        ASSERT_TRUE(new_a == a);
+    }
+
+    {
+        vector<ColumnarSensorSample> v(3);                                      // Поколоночная сериализация.
+        static_cast<SensorSample<true>&>(v[2]) = a;
+        ostringstream output(ios_base::binary);
+        {
+            Archive<ostringstream> oa(output);
+            oa << v;
+        }
+
+        istringstream input(output.str(), ios_base::binary);
+        Archive<istringstream> ia(input);
+        vector<ColumnarSensorSample> new_v;
+        ia >> new_v;
+        ASSERT_EQUAL(new_v.size(), v.size());
+        ASSERT_TRUE(new_v[2] == a);
+    }
+
+    {
+        string data = coalesced_output.str();                                   // Данные обрываются внутри серии полей.
+        istringstream input(data.substr(0, 10), ios_base::binary);
+        Archive<istringstream> ia(input);
+        SensorSample<true> new_a;
+        ASSERT_EQUAL(ia.try_serialize(new_a), Status::UnexpectedEnd);
+    }
+}
+
+void TestHashingSink()                                                          // хеширование при сериализации
+{
+    map<int, vector<string>> a = { { 1, { "one", "uno" } }, { 2, { "two" } } };
+    vector<double> b(100, 0.25);
+
+    ostringstream output(ios_base::binary);
+    HashingTee<ostringstream> tee(output);
+    {
+        Archive<HashingTee<ostringstream>> oa(tee);
+        oa << a;
+        oa << b;
+    }
+
+    const string data = output.str();                                           // Данные передаются в приемник без изменений,
+    ASSERT_EQUAL(tee.size(), data.size());                                      // а хеш совпадает с хешем буфера.
+    ASSERT_EQUAL(tee.hash(), stream_hash(data.data(), data.size()));
+
+    StreamHash pieces;                                                          // Хеш не зависит от размера частей.
+    for (size_t i = 0; i < data.size(); i += i % 7 + 1)
+    {
+        pieces.update(data.data() + i, min(data.size() - i, i % 7 + 1));
+    }
+    ASSERT_EQUAL(pieces.digest(), tee.hash());
+
+    HashingSink sink;                                                           // Хеши секций – хеши отдельных объектов.
+    vector<uint64_t> sections;
+    {
+        Archive<HashingSink> oa(sink);
+        oa << a;
+        sections.push_back(sink.end_section());
+        oa << b;
+        sections.push_back(sink.end_section());
+        oa << a;
+        sections.push_back(sink.end_section());
+    }
+    ASSERT_EQUAL(sections[0], content_hash(a));
+    ASSERT_EQUAL(sections[1], content_hash(b));
+    ASSERT_EQUAL(sections[2], sections[0]);
+
+    auto c = a;                                                                 // Изменение объекта изменяет хеш.
+    ASSERT_EQUAL(content_hash(c), content_hash(a));
+    c[2].push_back("dos");
+    ASSERT_TRUE(content_hash(c) != content_hash(a));
+    ASSERT_TRUE(stream_hash("", 0) != stream_hash("\0", 1));
+}
+
+static string EncodeQuotes(vector<Quote>& quotes, EncodingCache* cache)         // Функция для сериализации сообщений (с кэшем кодирования
+{                                                                               // или без него).
+    ostringstream output(ios_base::binary);
+    Archive<ostringstream> oa(output);
+    oa.set_encoding_cache(cache);
+    oa << quotes;
+    return output.str();
+}
+
+void TestEncodingCache()                                                        // кэш кодирования вложенных объектов
+{
+    auto table = make_shared<map<int, string>>();
+    (*table)[1] = "one";
+    (*table)[2] = "two";
+
+    vector<Quote> quotes(3);
+    for (int i = 0; i < 3; i++)
+    {
+        quotes[i].id = i;
+        quotes[i].table = Memoized<map<int, string>>(table);
+    }
+
+    EncodingCache cache;                                                        // Формат совпадает с сериализацией без кэша, таблица
+    const string plain = EncodeQuotes(quotes, nullptr);                         // сериализуется один раз.
+    ASSERT_EQUAL(EncodeQuotes(quotes, &cache), plain);
+    ASSERT_EQUAL(cache.size(), 1u);
+    ASSERT_EQUAL(cache.miss_count(), 1u);
+    ASSERT_EQUAL(cache.hit_count(), 2u);
+
+    {
+        istringstream input(plain, ios_base::binary);
+        Archive<istringstream> ia(input);
+        vector<Quote> new_quotes;
+        ia >> new_quotes;
+        ASSERT_EQUAL(new_quotes.size(), 3u);
+        ASSERT_EQUAL(*new_quotes[2].table, *table);
+        ASSERT_EQUAL(new_quotes[2].table.version(), 0u);
+    }
+
+    (*table)[3] = "three";                                                      // Новая версия сериализуется заново.
+    for (auto& quote : quotes)
+    {
+        quote.table.set_version(1);
+    }
+    const string updated = EncodeQuotes(quotes, &cache);
+    ASSERT_EQUAL(updated, EncodeQuotes(quotes, nullptr));
+    ASSERT_EQUAL(cache.miss_count(), 2u);
+    ASSERT_EQUAL(cache.size(), 1u);
+
+    {
+        ostringstream output(ios_base::binary);                                 // Другие параметры кодирования – другое представление.
+        Archive<ostringstream> oa(output);
+        oa.set_encoding_cache(&cache);
+        oa.set_packed_keys(true);
+        oa << quotes[0];
+        ASSERT_EQUAL(cache.miss_count(), 3u);
+
+        size_t lookups = cache.miss_count() + cache.hit_count();                // Со словарем строк кэш не используется.
+        oa.set_string_dictionary(true);
+        oa << quotes[0];
+        ASSERT_EQUAL(cache.miss_count() + cache.hit_count(), lookups);
+    }
+
+    quotes.clear();                                                             // Записи удаленных объектов удаляются.
+    table.reset();
+    ASSERT_EQUAL(cache.size(), 1u);
+    cache.prune();
+    ASSERT_EQUAL(cache.size(), 0u);
+    ASSERT_EQUAL(cache.bytes(), 0u);
+}
+
+static vector<string> ShardFiles(size_t count)                                  // Функция для получения имен файлов шардов.
+{
+    vector<string> files;
+    for (size_t i = 0; i < count; i++)
+    {
+        files.push_back("shard" + to_string(i) + ".bin");
+    }
+    return files;
+}
+
+void TestShardedArchive()                                                       // архив из нескольких файлов
+{
+    vector<vector<string>> a;
+    for (int i = 0; i < 10; i++)
+    {
+        a.push_back(vector<string>(size_t(i), to_string(i)));
+    }
+
+    ShardedWriter writer(ShardFiles(3));                                        // Объекты делятся между шардами поровну.
+    ShardManifest manifest = writer.write(a, "shards.manifest");
+    ASSERT_EQUAL(manifest.counts, vector<uint64_t>({ 3, 3, 4 }));
+
+    {
+        ShardedReader reader("shards.manifest");
+        ASSERT_EQUAL(reader.manifest().files, ShardFiles(3));
+        list<vector<string>> new_a;
+        reader.read(new_a);
+        ASSERT_EQUAL(vector<vector<string>>(new_a.begin(), new_a.end()), a);
+    }
+
+    {
+        list<PodClass> b = { PodClass(1, 'a', 2, 3) };                          // Шардов больше, чем объектов.
+        ShardedWriter(ShardFiles(4)).write(b, "shards.manifest");
+        vector<PodClass> new_b;
+        ShardedReader("shards.manifest").read(new_b);
+        ASSERT_EQUAL(new_b, vector<PodClass>(b.begin(), b.end()));
+    }
+
+    size_t fail_counter = 0;
+    try                                                                         // Шард короче, чем указано в манифесте.
+    {
+        ofstream("shard3.bin", ios_base::binary | ios_base::trunc);
+        vector<PodClass> new_b;
+        ShardedReader("shards.manifest").read(new_b);
+    }
+    catch (const invalid_argument&)
+    {
+        fail_counter++;
+    }
+
+    try
+    {
+        ShardedReader reader("missing/shards.manifest");
+    }
+    catch (const runtime_error&)
+    {
+        fail_counter++;
+    }
+    ASSERT_EQUAL(fail_counter, 2u);
+}
+
+struct DefaultSetup                                                             // Функции настройки архивов для Reencode: параметры
+{                                                                               // кодирования по умолчанию,
+    template <typename Stream>
+    void operator()(Archive<Stream>&) const {}
+};
+
+struct PackedKeysSetup                                                          // упаковка ключей,
+{
+    bool enabled;
+
+    template <typename Stream>
+    void operator()(Archive<Stream>& archive) const
+    {
+        archive.set_packed_keys(enabled);
+    }
+};
+
+struct BlobLayoutSetup                                                          // раскладка «смещения и блок данных» (и словарь строк).
+{
+    bool dictionary;
+
+    template <typename Stream>
+    void operator()(Archive<Stream>& archive) const
+    {
+        archive.set_blob_layout(true);
+        archive.set_string_dictionary(dictionary);
+    }
+};
+
+template <typename From, typename To, typename Setup = DefaultSetup>            // Функция для сериализации объекта from и десериализации
+string Reencode(From& from, To& to, Setup setup = Setup())                      // его в объект другого типа (оба архива настраиваются
+{                                                                               // функцией setup). Возвращает данные.
+    ostringstream output(ios_base::binary);
+    {
+        Archive<ostringstream> oa(output);
+        setup(oa);
+        oa << from;
+    }
+
+    istringstream input(output.str(), ios_base::binary);
+    Archive<istringstream> ia(input);
+    setup(ia);
+    ia >> to;
+    return output.str();
+}
+
+void TestFlatContainers()                                                       // FlatSet и FlatMap
+{
+    map<int, string> a = { { 3, "three" }, { 1, "one" }, { 2, "two" } };       // Архив std::map читается в FlatMap и наоборот.
+    FlatMap<int, string> flat_a;
+    const string data = Reencode(a, flat_a);
+    ASSERT_EQUAL(flat_a.size(), 3u);
+    ASSERT_EQUAL(flat_a.at(2), "two");
+    ASSERT_EQUAL(flat_a.count(4), 0u);
+    ASSERT_EQUAL(flat_a.begin()->first, 1);
+
+    map<int, string> new_a;
+    ASSERT_EQUAL(Reencode(flat_a, new_a), data);
+    ASSERT_EQUAL(new_a, a);
+
+    for (int packed = 0; packed < 2; packed++)                                  // Упакованные ключи.
+    {
+        set<int64_t> b;
+        for (int64_t i = 0; i < 1000; i++)
+        {
+            b.insert(i * i);
+        }
+        FlatSet<int64_t> flat_b;
+        PackedKeysSetup setup = { packed != 0 };
+        const string packed_data = Reencode(b, flat_b, setup);
+        ASSERT_EQUAL(flat_b.size(), b.size());
+        ASSERT_TRUE(equal(b.begin(), b.end(), flat_b.begin()));
+
+        set<int64_t> new_b;
+        ASSERT_EQUAL(Reencode(flat_b, new_b, setup), packed_data);
+        ASSERT_EQUAL(new_b, b);
+    }
+
+    vector<int> c = { 5, 1, 5, 3 };                                             // Неупорядоченные данные сортируются, повторы
+    FlatSet<int> flat_c;                                                        // отбрасываются.
+    Reencode(c, flat_c);
+    ASSERT_TRUE(flat_c == FlatSet<int>({ 1, 3, 5 }));
+
+    FlatMap<string, int> d;                                                     // Изменение контейнера.
+    d["b"] = 2;
+    d["a"] = 1;
+    ASSERT_TRUE(d.insert({ "c", 3 }).second);
+    ASSERT_FALSE(d.insert({ "a", 10 }).second);
+    ASSERT_EQUAL(d.erase("b"), 1u);
+    FlatMap<string, int> expected_d = { { "a", 1 }, { "c", 3 } };
+    ASSERT_TRUE(d == expected_d);
+
+    {
+        istringstream input(data.substr(0, data.size() - 1), ios_base::binary); // Данные обрываются.
+        Archive<istringstream> ia(input);
+        FlatMap<int, string> e;
+        ASSERT_TRUE(ia.try_serialize(e) != Status::Ok);
+    }
+}
+
+void TestBitContainers()                                                        // std::vector<bool> и std::bitset
+{
+    for (size_t size : { 0, 1, 7, 8, 9, 63, 64, 65, 4097, 5000 })             // Размеры на границах байт, слов и блоков.
+    {
+        vector<bool> a(size);
+        for (size_t i = 0; i < size; i++)
+        {
+            a[i] = (i * 7 + size) % 3 == 0;
+        }
+        vector<bool> new_a = { true };
+        const string data = Reencode(a, new_a);
+        ASSERT_EQUAL(data.size(), sizeof(uint32_t) + (size + 7) / 8);           // 8 элементов в байте.
+        ASSERT_EQUAL(new_a, a);
+    }
+
+    bitset<77> b;                                                               // Размер std::bitset не записывается.
+    b.set(0).set(13).set(64).set(76);
+    bitset<77> new_b;
+    new_b.set(5);
+    ASSERT_EQUAL(Reencode(b, new_b).size(), 10u);
+    ASSERT_TRUE(new_b == b);
+
+    vector<bitset<3>> c(5, bitset<3>("101"));                                   // Вложенные контейнеры.
+    vector<bitset<3>> new_c;
+    Reencode(c, new_c);
+    ASSERT_TRUE(new_c == c);
+
+    vector<bool> d(100, true);
+    vector<bool> new_d;
+    const string data = Reencode(d, new_d);
+    {
+        istringstream input(data.substr(0, data.size() - 1), ios_base::binary); // Данные обрываются.
+        Archive<istringstream> ia(input);
+        vector<bool> e;
+        ASSERT_TRUE(ia.try_serialize(e) != Status::Ok);
+    }
+    {
+        string huge = data.substr(0, sizeof(uint32_t));                         // Заявленный размер больше размера потока.
+        huge[3] = '\x7f';
+        istringstream input(huge, ios_base::binary);
+        Archive<istringstream> ia(input);
+        vector<bool> e;
+        ASSERT_TRUE(ia.try_serialize(e) != Status::Ok);
+        ASSERT_TRUE(e.capacity() < 1000);
+    }
+}
+
+void TestBlobLayout()                                                           // раскладка «смещения и блок данных»
+{
+    const BlobLayoutSetup blob = { false };
+    vector<string> a = { "the", "", "quick", "brown", "", "fox" };
+    vector<string> new_a = { "old" };
+    const string data = Reencode(a, new_a, blob);
+    ASSERT_EQUAL(new_a, a);
+    ASSERT_EQUAL(data.size(), sizeof(uint32_t) * (1 + a.size()) + 16);          // Количество, концы элементов и 16 байт данных.
+
+    BlobSequence<char> b;                                                       // Тот же архив читается в BlobSequence.
+    Reencode(a, b, blob);
+    ASSERT_EQUAL(b.size(), a.size());
+    ASSERT_EQUAL(b.data().size(), 16u);
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        ASSERT_TRUE(b[i] == a[i]);
+    }
+
+    BlobSequence<char> new_b;
+    vector<string> from_b;
+    ASSERT_EQUAL(Reencode(b, new_b, blob), data);
+    ASSERT_TRUE(new_b == b);
+    Reencode(b, from_b, blob);
+    ASSERT_EQUAL(from_b, a);
+
+    vector<vector<int32_t>> c = { { 1, 2, 3 }, {}, { -4 } };                    // Векторы векторов.
+    vector<vector<int32_t>> new_c;
+    BlobSequence<int32_t> blob_c;
+    ASSERT_EQUAL(Reencode(c, new_c, blob).size(),
+                 sizeof(uint32_t) * (1 + c.size()) + 4 * sizeof(int32_t));
+    ASSERT_EQUAL(new_c, c);
+    Reencode(c, blob_c, blob);
+    ASSERT_EQUAL(blob_c[0][2], 3);
+    ASSERT_TRUE(blob_c[1].empty());
+
+    vector<string> d = { "dup", "dup", "dup" };                                 // Со словарем строк раскладка не применяется.
+    vector<string> new_d;
+    string dictionary_data = Reencode(d, new_d, BlobLayoutSetup{ true });
+    ASSERT_EQUAL(new_d, d);
+    vector<string> plain_d;
+    ASSERT_TRUE(Reencode(d, plain_d).size() > dictionary_data.size());
+
+    {
+        string corrupted = data;                                                // Концы элементов убывают.
+        corrupted[sizeof(uint32_t) * 2] = 100;
+        istringstream input(corrupted, ios_base::binary);
+        Archive<istringstream> ia(input);
+        ia.set_blob_layout(true);
+        vector<string> e;
+        ASSERT_EQUAL(ia.try_serialize(e), Status::InvalidData);
+    }
+    {
+        istringstream input(data.substr(0, data.size() - 1), ios_base::binary); // Данные обрываются.
+        Archive<istringstream> ia(input);
+        BlobSequence<char> e;
+        ASSERT_TRUE(ia.try_serialize(e) != Status::Ok);
+        ASSERT_TRUE(e.empty());
+    }
+}
+
+struct CompressedFloatsSetup                                                    // Функция настройки архива: сжатие чисел с плавающей
+{                                                                               // точкой.
+    template <typename Stream>
+    void operator()(Archive<Stream>& archive) const
+    {
+        archive.set_compressed_floats(true);
+    }
+};
+
+template <typename T, typename Setup = DefaultSetup>                            // Функция для сериализации объекта в строку (архив
+string EncodeToString(T&& t, Setup setup = Setup())                             // настраивается функцией setup, см. Reencode).
+{
+    ostringstream output(ios_base::binary);
+    Archive<ostringstream> oa(output);
+    setup(oa);
+    oa << t;
+    return output.str();
+}
+
+void TestUnsizedRanges()                                                        // последовательности без размера
+{
+    forward_list<string> a = { "one", "two", "three" };                         // Список записывается за один проход в том же формате,
+    vector<string> vector_a(a.begin(), a.end());                                // что и вектор.
+    const string data = EncodeToString(a);
+    ASSERT_EQUAL(data, EncodeToString(vector_a));
+
+    forward_list<string> new_a;
+    Reencode(a, new_a);
+    ASSERT_EQUAL(new_a, a);
+
+    forward_list<double> b = { 1.5, 1.5, 2.25, -3.0 };                          // Сжатые числа с плавающей точкой.
+    vector<double> vector_b(b.begin(), b.end());
+    CompressedFloatsSetup compressed;
+    ASSERT_EQUAL(EncodeToString(b, compressed),
+                 EncodeToString(vector_b, compressed));
+
+    istringstream numbers("4 8 15 16 23 42");                                   // Диапазон входных итераторов.
+    vector<int> c;
+    {
+        istringstream input(EncodeToString(
+            unsized_range(istream_iterator<int>(numbers),
+                          istream_iterator<int>())), ios_base::binary);
+        Archive<istringstream> ia(input);
+        ia >> c;
+    }
+    vector<int> expected_c = { 4, 8, 15, 16, 23, 42 };
+    ASSERT_EQUAL(c, expected_c);
+
+    int next = 0;                                                               // Последовательность, которую возвращает функция,
+    auto squares = generated<int64_t>([&](int64_t& item)                        // в файле.
+    {
+        item = int64_t(next) * next;
+        return ++next <= 1000;
+    });
+    {
+        ofstream output("test.bin", ios_base::binary);
+        Archive<ofstream> oa(output);
+        int64_t marker = -1;
+        oa << squares;
+        oa << marker;
+    }
+    {
+        ifstream input("test.bin", ios_base::binary);
+        Archive<ifstream> ia(input);
+        list<int64_t> d;
+        int64_t marker = 0;
+        ia >> d;
+        ia >> marker;
+        ASSERT_EQUAL(d.size(), 1000u);
+        ASSERT_EQUAL(d.back(), 999 * 999);
+        ASSERT_EQUAL(marker, -1);
+    }
+
+    {
+        HashingSink sink;                                                       // Поток без позиционирования.
+        Archive<HashingSink> oa(sink);
+        vector<int> e = { 1, 2 };
+        auto range = unsized_range(e.begin(), e.end());
+        ASSERT_EQUAL(oa.try_serialize(range), Status::UnsupportedType);
+    }
+}
+
+/*  Функции для проверки производительности.
+    Каждая функция выполняет одну операцию сериализации
+    или десериализации в памяти; время выполнения
+    замеряется в TestRunner::RunPerfTest.
+*/
+
+static map<int64_t, string> CreatePerfMap()                                     // Функция для создания отображения для тестов
+{                                                                               // производительности.
+    map<int64_t, string> m;
+    for (int64_t i = 0; i < 1000; i++)
+    {
+        m[i * 7919] = "value #" + to_string(i);
+    }
+    return m;
+}
+
+void PerfMapDecode()                                                            // десериализация std::map
+{
+    static const string data = []                                               // Сериализуем отображение один раз.
+    {
+        map<int64_t, string> m = CreatePerfMap();
+        ostringstream output;
+        Archive<ostringstream> oa(output);
+        oa << m;
+        return output.str();
+    }();
+
+    istringstream input(data);
+    Archive<istringstream> ia(input);
+
+    map<int64_t, string> m;
+    ia >> m;
+
+    AssertEqual(m.size(), 1000u);
+}
+
+void PerfPodVectorEncode()                                                      // сериализация вектора пользовательских классов
+{
+    static vector<PodClass> v(1000, PodClass(-1, 'b', 2, 500));
+
+    ostringstream output;
+    Archive<ostringstream> oa(output);
+    oa << v;
+
+    AssertFalse(output.str().empty());
+}
+
+static const size_t garbage_frame_size = 64;                                    // Размер и количество кадров со случайными данными для
+static const size_t garbage_frame_count = 1000;                                 // сравнения режимов обработки ошибок.
+
+static const string& GarbageFrames()                                            // Функция для получения потока кадров со случайными данными
+{                                                                               // (создается один раз).
+    static const string frames = []
+    {
+        mt19937 generator(2020);
+        string data(garbage_frame_size * garbage_frame_count, '\0');
+
+        for (auto& c : data)
+        {
+            c = static_cast<char>(generator());
+        }
+        return data;
+    }();
+
+    return frames;
+}
+
+void PerfGarbageFramesThrow()                                                   // десериализация кадров со случайными данными
+{                                                                               // с исключениями
+    istringstream input(GarbageFrames());
+    size_t failed_frames = 0;
+
+    for (size_t i = 0; i < garbage_frame_count; i++)
+    {
+        input.clear();
+        input.seekg(i * garbage_frame_size);
+
+        Archive<istringstream> ia(input);
+        ia.set_memory_budget(1 << 20);
+
+        ClassWithNestedStruct frame;
+        try
+        {
+            ia >> frame;
+        }
+        catch (const std::exception&)
+        {
+            failed_frames++;
+        }
+    }
+
+    AssertTrue(failed_frames > 0);
+}
+
+void PerfGarbageFramesStatus()                                                  // десериализация кадров со случайными данными
+{                                                                               // в режиме кодов ошибок
+    istringstream input(GarbageFrames());
+    size_t failed_frames = 0;
+
+    for (size_t i = 0; i < garbage_frame_count; i++)
+    {
+        input.clear();
+        input.seekg(i * garbage_frame_size);
+
+        Archive<istringstream> ia(input);
+        ia.set_memory_budget(1 << 20);
+
+        ClassWithNestedStruct frame;
+        if (ia.try_serialize(frame) != Status::Ok)
+        {
+            failed_frames++;
+        }
+    }
+
+    AssertTrue(failed_frames > 0);
+}
+
+#ifdef SERIALIZATION_STATISTICS
+void TestStatistics()                                                           // статистика сериализации
+{
+    ClassWithNestedStruct a(1,
+                            { 20, 30, 40 },
+                            500.00,
+                            "6k",
+                            StructWithBasicTypesAndContainers(2,
+                                                              0.35,
+                                                              3.1,
+                                                              'u',
+                                                              { 90, 100, 30 },
+                                                              { 0.5, 0.6 }),
+                            { "70k", "80k", "90k" });
+
+    size_t fail_counter = 0;
+    uint64_t written_bytes = 0;
+
+    {
+        CREATE_TEST_OUTPUT_ARCHIVE(oa);
+        SerializeAndCountFails(a, oa, fail_counter);
+
+        const Statistics& statistics = oa.statistics();
+        const TypeStatistics* nested = statistics.find<ClassWithNestedStruct>();
+        const TypeStatistics* ints = statistics.find<int>();
+        const TypeStatistics* vectors = statistics.find<vector<int>>();
+
+        ASSERT_TRUE(nested != nullptr);
+        ASSERT_TRUE(ints != nullptr);
+        ASSERT_TRUE(vectors != nullptr);
+        ASSERT_FALSE(statistics.find<PodClass>());
+
+        ASSERT_EQUAL(nested->calls, 1);
+        ASSERT_EQUAL(nested->bytes, statistics.total_bytes());
+        ASSERT_EQUAL(ints->calls, 8);                                           // a, b (3), e.a, e.e (3)
+        ASSERT_EQUAL(ints->bytes, 8 * sizeof(int));
+        ASSERT_EQUAL(vectors->bytes, sizeof(uint32_t) + 3 * sizeof(int));
+        ASSERT_EQUAL(vectors->sizes[2], 1);                                     // размер 3 – корзина [2, 4)
+
+        ostringstream json;
+        statistics.write_json(json);
+        ASSERT_TRUE(json.str().find("\"ClassWithNestedStruct\"") != string::npos);
+
+        written_bytes = statistics.total_bytes();
+    }
+
+    {
+        CREATE_TEST_INPUT_ARCHIVE(ia);
+
+        ClassWithNestedStruct new_a;
+        SerializeAndCountFails(new_a, ia, fail_counter);
+
+        ASSERT_EQUAL(new_a, a);
+        ASSERT_EQUAL(ia.statistics().total_bytes(), written_bytes);
+        ASSERT_EQUAL(ia.statistics().find<string>()->calls, 4);
+
+        ia.reset_statistics();
+        ASSERT_FALSE(ia.statistics().total_bytes());
+        ASSERT_FALSE(fail_counter);
+    }
+}
+#endif
+
+static const string& SetData(bool packed)                                       // Функция для получения сериализованного плотного
+{                                                                               // множества идентификаторов без упаковки и с упаковкой
+    static const vector<string> data = []                                       // ключей (создаются один раз).
+    {
+        set<int64_t> ids;
+        for (int64_t i = 0; i < 10000; i++)
+        {
+            ids.insert(1000000 + i * 2);
+        }
+
+        vector<string> result;
+        for (int i = 0; i < 2; i++)
+        {
+            ostringstream output;
+            Archive<ostringstream> oa(output);
+            oa.set_packed_keys(i == 1);
+            oa << ids;
+            result.push_back(output.str());
+        }
+        return result;
+    }();
+
+    return data[packed];
+}
+
+static void DecodeSet(bool packed)                                              // Функция для десериализации множества.
+{
+    istringstream input(SetData(packed));
+    Archive<istringstream> ia(input);
+    ia.set_packed_keys(packed);
+
+    set<int64_t> ids;
+    ia >> ids;
+
+    AssertEqual(ids.size(), 10000u);
+}
+
+void PerfPlainSetDecode()                                                       // десериализация множества без упаковки ключей
+{
+    DecodeSet(false);
+}
+
+void PerfPackedSetDecode()                                                      // десериализация множества с упакованными ключами
+{
+    DecodeSet(true);
+}
+
+static const string& SeriesData(bool compressed)                                // Функция для получения сериализованного временного ряда
+{                                                                               // без сжатия и со сжатием (создаются один раз, при этом
+    static const vector<string> data = []                                       // выводится размер значения в байтах для каждого варианта).
+    {
+        const size_t size = 10000;
+        vector<double> series = CreateSeries(size);
+        vector<string> result;
+
+        for (int i = 0; i < 2; i++)
+        {
+            ostringstream output;
+            Archive<ostringstream> oa(output);
+            oa.set_compressed_floats(i == 1);
+            oa << series;
+            result.push_back(output.str());
+            cerr << "Float series (" << (i ? "xor" : "raw") << "): "
+                 << double(result.back().size()) / size << " bytes per value"
+                 << endl;
+        }
+        return result;
+    }();
+
+    return data[compressed];
+}
+
+static void DecodeSeries(bool compressed)                                       // Функция для десериализации временного ряда.
+{
+    istringstream input(SeriesData(compressed));
+    Archive<istringstream> ia(input);
+    ia.set_compressed_floats(compressed);
+
+    vector<double> series;
+    ia >> series;
+
+    AssertEqual(series.size(), 10000u);
+}
+
+void PerfFloatSeriesDecodeRaw()                                                 // десериализация временного ряда без сжатия
+{
+    DecodeSeries(false);
+}
+
+void PerfFloatSeriesDecodeXor()                                                 // десериализация временного ряда со сжатием XOR
+{
+    DecodeSeries(true);
+}
+
+static vector<int64_t>& FileData()                                              // Функция для получения данных для тестов файлового
+{                                                                               // ввода-вывода (1 МБ).
+    static vector<int64_t> values = []
+    {
+        vector<int64_t> result(1 << 17);
+        for (size_t i = 0; i < result.size(); i++)
+        {
+            result[i] = int64_t(i) * 7919;
+        }
+        return result;
+    }();
+    return values;
+}
+
+void PerfOfstreamEncode()                                                       // сериализация в файл через std::ofstream
+{
+    ofstream output("perf.bin", ios_base::binary);
+    Archive<ofstream> oa(output);
+    oa << FileData();
+}
+
+void PerfFileSinkEncode()                                                       // сериализация в файл через FileSink
+{
+    FileSink sink("perf.bin");
+    Archive<FileSink> oa(sink);
+    oa << FileData();
+    sink.close();
+}
+
+static const char* PerfInputFile()                                              // Функция для получения файла для тестов десериализации
+{                                                                               // (создается один раз).
+    static const char* name = []
+    {
+        ofstream output("perf_input.bin", ios_base::binary);
+        Archive<ofstream> oa(output);
+        oa << FileData();
+        return "perf_input.bin";
+    }();
+    return name;
+}
+
+void PerfIfstreamDecode()                                                       // десериализация из файла через std::ifstream
+{
+    ifstream input(PerfInputFile(), ios_base::binary);
+    Archive<ifstream> ia(input);
+
+    vector<int64_t> values;
+    ia >> values;
+
+    AssertEqual(values.size(), FileData().size());
+}
+
+void PerfFileSourceDecode()                                                     // десериализация из файла через FileSource
+{
+    FileSource source(PerfInputFile());
+    Archive<FileSource> ia(source);
+
+    vector<int64_t> values;
+    ia >> values;
+
+    AssertEqual(values.size(), FileData().size());
+}
+
+static const string& RecordFile()                                               // Функция для получения файла записей для тестов
+{                                                                               // производительности (создается один раз).
+    static const string data = []
+    {
+        ostringstream output(ios_base::binary);
+        RecordWriter writer(output);
+        for (int i = 0; i < 1000; i++)
+        {
+            vector<int64_t> record(i % 10 ? 100 : 2000, i);
+            writer.write(record);
+        }
+        return output.str();
+    }();
+    return data;
+}
+
+static void ScanRecords(size_t threads)                                         // Функция для обработки файла записей.
+{
+    ParallelScanner scanner(threads);
+    atomic<int64_t> sum(0);
+    scanner.scan<vector<int64_t>>(RecordFile(),
+        [&](size_t, vector<int64_t>& record)
+        {
+            sum += int64_t(record.size());
+        });
+
+    AssertEqual(sum.load(), int64_t(900 * 100 + 100 * 2000));
+}
+
+void PerfRecordScanSingleThread()                                               // обработка файла записей в одном потоке
+{
+    ScanRecords(1);
+}
+
+void PerfRecordScanParallel()                                                   // обработка файла записей в нескольких потоках
+{
+    ScanRecords(4);
+}
+
+static vector<Polymorphic<Message>> CreateMessages()                            // Функция для создания полиморфных сообщений для тестов
+{                                                                               // производительности.
+    vector<Polymorphic<Message>> messages;
+    for (int i = 0; i < 1000; i++)
+    {
+        if (i % 2)
+        {
+            messages.emplace_back(new TextMessage(i, "message"));
+        }
+        else
+        {
+            messages.emplace_back(new ValueMessage(i, { double(i) }));
+        }
+    }
+    return messages;
+}
+
+void PerfPolymorphicEncode()                                                    // сериализация полиморфных объектов
+{
+    static vector<Polymorphic<Message>> messages = CreateMessages();
+
+    ostringstream output;
+    Archive<ostringstream> oa(output);
+    oa << messages;
+}
+
+void PerfPolymorphicDecode()                                                    // десериализация полиморфных объектов
+{
+    static const string data = []
+    {
+        vector<Polymorphic<Message>> messages = CreateMessages();
+        ostringstream output;
+        Archive<ostringstream> oa(output);
+        oa << messages;
+        return output.str();
+    }();
+
+    istringstream input(data);
+    Archive<istringstream> ia(input);
+
+    vector<Polymorphic<Message>> messages;
+    ia >> messages;
+
+    AssertEqual(messages.size(), 1000u);
+}
+
+template <bool Coalesced>                                                       // Функция для сериализации вектора структур с
+static void EncodeSensorSamples()                                               // фундаментальными полями.
+{
+    static vector<SensorSample<Coalesced>> v = []
+    {
+        vector<SensorSample<Coalesced>> samples(1000);
+        for (size_t i = 0; i < samples.size(); i++)
+        {
+            samples[i].id = int32_t(i);
+            samples[i].x = double(i);
+            samples[i].name = "s";
+            samples[i].time = int64_t(i) * 1000;
+        }
+        return samples;
+    }();
+
+    ostringstream output;
+    Archive<ostringstream> oa(output);
+    oa << v;
+
+    AssertFalse(output.str().empty());
+}
+
+void PerfSeparateFieldsEncode()                                                 // сериализация полей по одному
+{
+    EncodeSensorSamples<false>();
+}
+
+void PerfCoalescedFieldsEncode()                                                // сериализация полей одной операцией
+{
+    EncodeSensorSamples<true>();
+}
+
+static vector<PodClass> CreateHashedPods()                                      // Функция для создания вектора для тестов хеширования.
+{
+    vector<PodClass> v;
+    for (int i = 0; i < 10000; i++)
+    {
+        v.emplace_back(i, 'h', uint32_t(i) * 3, int64_t(i) << 20);
+    }
+    return v;
+}
+
+void PerfEncodeThenHash()                                                       // сериализация в буфер и хеширование буфера
+{
+    static vector<PodClass> v = CreateHashedPods();
+
+    ostringstream output;
+    {
+        Archive<ostringstream> oa(output);
+        oa << v;
+    }
+    const string data = output.str();
+    AssertTrue(stream_hash(data.data(), data.size()) != 0);
+}
+
+void PerfHashingSinkEncode()                                                    // хеширование во время сериализации
+{
+    static vector<PodClass> v = CreateHashedPods();
+
+    AssertTrue(content_hash(v) != 0);
+}
+
+static vector<Quote>& PerfQuotes()                                              // Функция для получения сообщений с общей таблицей для
+{                                                                               // тестов производительности.
+    static vector<Quote> quotes = []
+    {
+        auto table = make_shared<map<int, string>>();
+        for (int i = 0; i < 1000; i++)
+        {
+            (*table)[i] = "instrument #" + to_string(i);
+        }
+
+        vector<Quote> quotes(100);
+        for (int i = 0; i < 100; i++)
+        {
+            quotes[i].id = i;
+            quotes[i].table = Memoized<map<int, string>>(table);
+        }
+        return quotes;
+    }();
+    return quotes;
+}
+
+void PerfQuotesEncode()                                                         // сериализация сообщений без кэша кодирования
+{
+    AssertFalse(EncodeQuotes(PerfQuotes(), nullptr).empty());
+}
+
+void PerfQuotesEncodeCached()                                                   // сериализация сообщений с кэшем кодирования
+{
+    static EncodingCache cache;
+    AssertFalse(EncodeQuotes(PerfQuotes(), &cache).empty());
+}
+
+static void WriteShards(size_t count)                                           // Функция для записи снимка в count файлов.
+{
+    static vector<vector<int64_t>> snapshot(64, vector<int64_t>(4096, 7));
+
+    ShardedWriter writer(ShardFiles(count));
+    writer.write(snapshot, "perf.manifest");
+}
+
+void PerfShardedWriteSingle()                                                   // запись снимка в один файл
+{
+    WriteShards(1);
+}
+
+void PerfShardedWriteParallel()                                                 // запись снимка в четыре файла параллельно
+{
+    WriteShards(4);
+}
+
+void PerfFlatMapDecode()                                                        // десериализация FlatMap
+{
+    static const string data = []
+    {
+        map<int64_t, string> m = CreatePerfMap();
+        ostringstream output;
+        Archive<ostringstream> oa(output);
+        oa << m;
+        return output.str();
+    }();
+
+    istringstream input(data);
+    Archive<istringstream> ia(input);
+
+    FlatMap<int64_t, string> m;
+    ia >> m;
+
+    AssertEqual(m.size(), 1000u);
+}
+
+template <typename Map>                                                         // Функция для поиска всех ключей отображения (и такого же
+static void LookupKeys(const Map& m)                                            // количества отсутствующих ключей).
+{
+    size_t found = 0;
+    for (int64_t i = 0; i < 2000; i++)
+    {
+        found += m.count(i / 2 * 7919 + i % 2);
+    }
+    AssertEqual(found, 1000u);
+}
+
+void PerfMapLookup()                                                            // поиск в std::map
+{
+    static const map<int64_t, string> m = CreatePerfMap();
+    LookupKeys(m);
+}
+
+void PerfFlatMapLookup()                                                        // поиск в FlatMap
+{
+    static const FlatMap<int64_t, string> m = []
+    {
+        map<int64_t, string> source = CreatePerfMap();
+        FlatMap<int64_t, string> flat;
+        flat.load(vector<pair<int64_t, string>>(source.begin(), source.end()));
+        return flat;
+    }();
+    LookupKeys(m);
+}
+
+static const vector<bool>& PerfBits()                                           // Функция для получения вектора bool для тестов
+{                                                                               // производительности (создается один раз).
+    static const vector<bool> bits = []
+    {
+        mt19937 generator(2020);
+        vector<bool> v(1 << 16);
+        for (size_t i = 0; i < v.size(); i++)
+        {
+            v[i] = generator() % 2 != 0;
+        }
+        return v;
+    }();
+    return bits;
+}
+
+void PerfBitVectorEncode()                                                      // сериализация вектора bool
+{
+    vector<bool> v = PerfBits();
+    ostringstream output;
+    Archive<ostringstream> oa(output);
+    oa << v;
+
+    AssertEqual(output.str().size(), sizeof(uint32_t) + v.size() / 8);
+}
+
+void PerfBitVectorDecode()                                                      // десериализация вектора bool
+{
+    static const string data = []
+    {
+        vector<bool> v = PerfBits();
+        ostringstream output;
+        Archive<ostringstream> oa(output);
+        oa << v;
+        return output.str();
+    }();
+
+    istringstream input(data);
+    Archive<istringstream> ia(input);
+
+    vector<bool> v;
+    ia >> v;
+
+    AssertEqual(v.size(), PerfBits().size());
+}
+
+static string EncodeTokens(bool blob_layout)                                    // Функция для сериализации вектора коротких токенов.
+{
+    mt19937 generator(2020);
+    vector<string> tokens(20000);
+    for (auto& token : tokens)
+    {
+        token.assign(1 + generator() % 8,
+                     static_cast<char>('a' + generator() % 26));
+    }
+
+    ostringstream output;
+    Archive<ostringstream> oa(output);
+    oa.set_blob_layout(blob_layout);
+    oa << tokens;
+    return output.str();
+}
+
+template <typename Tokens>                                                      // Функция для десериализации вектора токенов.
+static void DecodeTokens(bool blob_layout)
+{
+    static const string data[2] = { EncodeTokens(false), EncodeTokens(true) };
+
+    istringstream input(data[blob_layout]);
+    Archive<istringstream> ia(input);
+    ia.set_blob_layout(blob_layout);
+
+    Tokens tokens;
+    ia >> tokens;
+
+    AssertEqual(tokens.size(), 20000u);
+}
+
+void PerfTokensDecode()                                                         // десериализация вектора строк поэлементно
+{
+    DecodeTokens<vector<string>>(false);
+}
+
+void PerfTokensDecodeBlob()                                                     // десериализация вектора строк в раскладке «смещения и
+{                                                                               // блок данных»
+    DecodeTokens<vector<string>>(true);
+}
+
+void PerfTokensDecodeBlobSequence()                                             // десериализация BlobSequence
+{
+    DecodeTokens<BlobSequence<char>>(true);
+}
+
+void PerfForwardListEncode()                                                    // сериализация односвязного списка
+{
+    static forward_list<int64_t> l(10000, 7);
+
+    ostringstream output;
+    Archive<ostringstream> oa(output);
+    oa << l;
+
+    AssertEqual(output.str().size(),
+                sizeof(uint32_t) + sizeof(int64_t) * 10000);
+}
+
+void PerfGeneratedEncode()                                                      // сериализация последовательности, которую возвращает
+{                                                                               // функция
+    int64_t next = 0;
+    ostringstream output;
+    Archive<ostringstream> oa(output);
+    oa << generated<int64_t>([&](int64_t& item)
+    {
+        item = 7;
+        return ++next <= 10000;
+    });
+
+    AssertEqual(output.str().size(),
+                sizeof(uint32_t) + sizeof(int64_t) * 10000);
+}